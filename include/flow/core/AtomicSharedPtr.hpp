@@ -0,0 +1,127 @@
+// Copyright (c) 2024, Cisco Systems, Inc.
+// All rights reserved.
+
+#pragma once
+
+#include "Core.hpp"
+
+#include <atomic>
+#include <memory>
+#include <utility>
+
+FLOW_NAMESPACE_BEGIN
+
+/**
+ * @brief Shared pointer slot that can be loaded and stored concurrently.
+ *
+ * @details Uses std::atomic<std::shared_ptr> where the standard library provides it, and otherwise falls back to a
+ *          spinlock that is only held for the duration of a pointer copy.
+ *
+ * @tparam T The type pointed to.
+ */
+template<typename T>
+class AtomicSharedPtr
+{
+  public:
+    AtomicSharedPtr() = default;
+    AtomicSharedPtr(std::shared_ptr<T> ptr) : _ptr{std::move(ptr)} {}
+
+    AtomicSharedPtr(const AtomicSharedPtr&)            = delete;
+    AtomicSharedPtr& operator=(const AtomicSharedPtr&) = delete;
+
+    /**
+     * @brief Get a copy of the stored pointer.
+     * @returns The currently stored pointer.
+     */
+    [[nodiscard]] std::shared_ptr<T> load() const noexcept
+    {
+#if defined(__cpp_lib_atomic_shared_ptr)
+        return _ptr.load(std::memory_order_acquire);
+#else
+        Guard _(_lock);
+        return _ptr;
+#endif
+    }
+
+    /**
+     * @brief Replace the stored pointer.
+     * @param ptr The new pointer to store.
+     */
+    void store(std::shared_ptr<T> ptr) noexcept { exchange(std::move(ptr)); }
+
+    /**
+     * @brief Replace the stored pointer, returning the previous one.
+     * @param ptr The new pointer to store.
+     * @returns The previously stored pointer.
+     */
+    std::shared_ptr<T> exchange(std::shared_ptr<T> ptr) noexcept
+    {
+#if defined(__cpp_lib_atomic_shared_ptr)
+        return _ptr.exchange(std::move(ptr), std::memory_order_acq_rel);
+#else
+        Guard _(_lock);
+        std::swap(_ptr, ptr);
+        return ptr;
+#endif
+    }
+
+    /**
+     * @brief Replace the stored pointer if it is still the expected one.
+     *
+     * @param expected The pointer expected to be stored, updated to the stored pointer on failure.
+     * @param desired The new pointer to store.
+     *
+     * @returns true if the pointer was replaced, false otherwise.
+     */
+    bool compare_exchange(std::shared_ptr<T>& expected, std::shared_ptr<T> desired) noexcept
+    {
+#if defined(__cpp_lib_atomic_shared_ptr)
+        return _ptr.compare_exchange_strong(expected, std::move(desired), std::memory_order_acq_rel,
+                                            std::memory_order_acquire);
+#else
+        // The previous pointer is released after the lock, since releasing it can run arbitrary destructors.
+        std::shared_ptr<T> previous;
+        {
+            Guard _(_lock);
+            if (_ptr != expected)
+            {
+                expected = _ptr;
+                return false;
+            }
+
+            previous = std::exchange(_ptr, std::move(desired));
+        }
+
+        return true;
+#endif
+    }
+
+  private:
+#if defined(__cpp_lib_atomic_shared_ptr)
+    std::atomic<std::shared_ptr<T>> _ptr;
+#else
+    struct Guard
+    {
+        Guard(std::atomic_flag& lock) : _lock{lock}
+        {
+            while (_lock.test_and_set(std::memory_order_acquire))
+            {
+                _lock.wait(true, std::memory_order_relaxed);
+            }
+        }
+
+        ~Guard()
+        {
+            _lock.clear(std::memory_order_release);
+            _lock.notify_one();
+        }
+
+        std::atomic_flag& _lock;
+    };
+
+    mutable std::atomic_flag _lock;
+    std::shared_ptr<T> _ptr;
+#endif
+};
+
+FLOW_NAMESPACE_END
@@ -0,0 +1,312 @@
+// Copyright (c) 2024, Cisco Systems, Inc.
+// All rights reserved.
+
+#pragma once
+
+#include "Core.hpp"
+#include "NodeData.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+FLOW_NAMESPACE_BEGIN
+
+/**
+ * @brief Contiguous column of K records of the same type, with a validity bitmap marking null records.
+ *
+ * @details Columns let a single activation of a node carry a batch of records on each port, amortizing the cost of
+ *          locks, tasks and conversions over the whole batch. The values are stored in one contiguous array, and the
+ *          validity of record i is bit i % 64 of word i / 64 of the bitmap.
+ *
+ * @tparam T The type of the records. MUST NOT be bool, since std::vector<bool> is not contiguous.
+ */
+template<typename T>
+class Column
+{
+    static_assert(!std::same_as<T, bool>, "use Column<std::uint8_t> for boolean records");
+    static_assert(std::default_initializable<T>, "records of a column must be default constructible");
+
+  public:
+    using value_type = T;
+
+    Column() = default;
+
+    /**
+     * @brief Constructs a column of null records.
+     * @param size The number of records.
+     */
+    explicit Column(std::size_t size) : _values(size), _validity(WordCount(size), 0), _size{size} {}
+
+    /**
+     * @brief Constructs a column of valid records.
+     * @param values The values of the records.
+     */
+    Column(std::vector<T> values)
+        : _values{std::move(values)}, _validity(WordCount(_values.size()), ~std::uint64_t{0}), _size{_values.size()}
+    {
+    }
+
+    /**
+     * @brief Get the number of records in the column.
+     * @returns The number of records.
+     */
+    [[nodiscard]] std::size_t Size() const noexcept { return _size; }
+
+    /**
+     * @brief Check if the column has no records.
+     * @returns true if the column is empty, false otherwise.
+     */
+    [[nodiscard]] bool Empty() const noexcept { return _size == 0; }
+
+    /**
+     * @brief Reserves storage for a number of records.
+     * @param size The number of records to reserve storage for.
+     */
+    void Reserve(std::size_t size)
+    {
+        _values.reserve(size);
+        _validity.reserve(WordCount(size));
+    }
+
+    /**
+     * @brief Resizes the column, where added records are null.
+     * @param size The new number of records.
+     */
+    void Resize(std::size_t size)
+    {
+        for (std::size_t i = size; i < std::min(_size, _validity.size() * 64); ++i)
+        {
+            SetValid(i, false);
+        }
+
+        _values.resize(size);
+        _validity.resize(WordCount(size), 0);
+        _size = size;
+    }
+
+    /**
+     * @brief Appends a valid record.
+     * @param value The value of the record.
+     */
+    void PushBack(T value)
+    {
+        _values.push_back(std::move(value));
+        Resize(_values.size());
+        SetValid(_size - 1, true);
+    }
+
+    /**
+     * @brief Appends a null record.
+     */
+    void PushNull() { Resize(_size + 1); }
+
+    /**
+     * @brief Check if a record is valid.
+     * @param i The index of the record.
+     * @returns true if the record is valid, false if it is null.
+     */
+    [[nodiscard]] bool IsValid(std::size_t i) const noexcept { return (_validity[i / 64] >> (i % 64)) & 1; }
+
+    /**
+     * @brief Marks a record as valid or null.
+     * @param i The index of the record.
+     * @param valid Flag if the record is valid.
+     */
+    void SetValid(std::size_t i, bool valid) noexcept
+    {
+        const auto bit    = std::uint64_t{1} << (i % 64);
+        _validity[i / 64] = valid ? _validity[i / 64] | bit : _validity[i / 64] & ~bit;
+    }
+
+    /**
+     * @brief Sets the value of a record, and marks it as valid.
+     * @param i The index of the record.
+     * @param value The new value of the record.
+     */
+    void Set(std::size_t i, T value)
+    {
+        _values[i] = std::move(value);
+        SetValid(i, true);
+    }
+
+    /**
+     * @brief Get the number of null records.
+     * @returns The number of null records.
+     */
+    [[nodiscard]] std::size_t NullCount() const noexcept
+    {
+        std::size_t valid = 0;
+        for (const auto word : _validity)
+        {
+            valid += std::popcount(word);
+        }
+
+        return _size - valid;
+    }
+
+    /**
+     * @brief Get the value of a record, regardless of its validity.
+     * @param i The index of the record.
+     * @returns A reference to the value.
+     */
+    [[nodiscard]] T& operator[](std::size_t i) noexcept { return _values[i]; }
+
+    /**
+     * @brief Get the value of a record, regardless of its validity.
+     * @param i The index of the record.
+     * @returns A const reference to the value.
+     */
+    [[nodiscard]] const T& operator[](std::size_t i) const noexcept { return _values[i]; }
+
+    /**
+     * @brief Get the contiguous values of all records.
+     * @returns A span of the values.
+     */
+    [[nodiscard]] std::span<T> Values() noexcept { return _values; }
+
+    /**
+     * @brief Get the contiguous values of all records.
+     * @returns A const span of the values.
+     */
+    [[nodiscard]] std::span<const T> Values() const noexcept { return _values; }
+
+    /**
+     * @brief Get the validity bitmap of the records.
+     * @returns A span of the words of the bitmap.
+     */
+    [[nodiscard]] std::span<const std::uint64_t> Validity() const noexcept { return _validity; }
+
+    /**
+     * @brief Get the validity bitmap of the records.
+     * @returns A span of the words of the bitmap.
+     */
+    [[nodiscard]] std::span<std::uint64_t> Validity() noexcept { return _validity; }
+
+  private:
+    static constexpr std::size_t WordCount(std::size_t size) noexcept { return (size + 63) / 64; }
+
+  private:
+    std::vector<T> _values;
+    std::vector<std::uint64_t> _validity;
+    std::size_t _size = 0;
+};
+
+/**
+ * @brief Type-erased interface of node data holding a Column.
+ */
+class IBatchData
+{
+  public:
+    virtual ~IBatchData() = default;
+
+    /**
+     * @brief Get the number of records in the batch.
+     * @returns The number of records.
+     */
+    [[nodiscard]] virtual std::size_t BatchSize() const noexcept = 0;
+
+    /**
+     * @brief Check if a record of the batch is valid.
+     * @param i The index of the record.
+     * @returns true if the record is valid, false if it is null.
+     */
+    [[nodiscard]] virtual bool IsValid(std::size_t i) const noexcept = 0;
+};
+
+/**
+ * @brief Specialisation for columns, which can be detected as batches without knowing the record type.
+ */
+template<typename T>
+class NodeData<Column<T>> : public detail::NodeData<Column<T>>, public IBatchData
+{
+    using Base = detail::NodeData<Column<T>>;
+
+  public:
+    virtual ~NodeData() = default;
+
+    using Base::Base;
+    using Base::operator=;
+
+    [[nodiscard]] std::size_t BatchSize() const noexcept override { return this->_value.Size(); }
+
+    [[nodiscard]] bool IsValid(std::size_t i) const noexcept override { return this->_value.IsValid(i); }
+
+    std::size_t SizeInBytes() const override
+    {
+        const auto& column = this->_value;
+        return sizeof(*this) + column.Size() * sizeof(T) + column.Validity().size_bytes();
+    }
+
+    std::string ToString() const override
+    {
+        const auto& column = this->_value;
+        if (column.Empty())
+        {
+            return "[]";
+        }
+
+        std::string str = "[ ";
+        for (std::size_t i = 0; i < column.Size(); ++i)
+        {
+            str += column.IsValid(i) ? ::flow::ToString<T>(column[i]) : "null";
+            str += i + 1 < column.Size() ? ", " : " ]";
+        }
+
+        return str;
+    }
+
+  protected:
+    bool WriteBytes(std::ostream& stream) const override
+    {
+        if constexpr (!std::is_trivially_copyable_v<T>)
+        {
+            return false;
+        }
+        else
+        {
+            const auto& column       = this->_value;
+            const std::uint64_t size = column.Size();
+            stream.write(reinterpret_cast<const char*>(&size), sizeof(size));
+            stream.write(reinterpret_cast<const char*>(column.Values().data()),
+                         static_cast<std::streamsize>(column.Values().size_bytes()));
+            stream.write(reinterpret_cast<const char*>(column.Validity().data()),
+                         static_cast<std::streamsize>(column.Validity().size_bytes()));
+            return stream.good();
+        }
+    }
+
+    bool ReadBytes(std::istream& stream) override
+    {
+        if constexpr (!std::is_trivially_copyable_v<T>)
+        {
+            return false;
+        }
+        else
+        {
+            std::uint64_t size = 0;
+            if (!stream.read(reinterpret_cast<char*>(&size), sizeof(size)))
+            {
+                return false;
+            }
+
+            auto& column = this->_value;
+            column.Resize(size);
+            stream.read(reinterpret_cast<char*>(column.Values().data()),
+                        static_cast<std::streamsize>(column.Values().size_bytes()));
+            stream.read(reinterpret_cast<char*>(column.Validity().data()),
+                        static_cast<std::streamsize>(column.Validity().size_bytes()));
+            return static_cast<bool>(stream);
+        }
+    }
+};
+
+FLOW_NAMESPACE_END
@@ -6,9 +6,16 @@
 #include "Core.hpp"
 
 #include <chrono>
+#include <concepts>
+#include <functional>
 #include <memory>
+#include <optional>
+#include <ranges>
 #include <string_view>
+#include <tuple>
 #include <type_traits>
+#include <utility>
+#include <variant>
 
 FLOW_NAMESPACE_BEGIN
 
@@ -39,6 +46,48 @@ struct is_specialization_of<C<Args...>, C> final : std::true_type
 template<typename T, template<typename...> class C>
 constexpr bool is_specialization_of_v = is_specialization_of<T, C>::value;
 
+/**
+ * @brief Check if operator== of a type compiles, including for the elements of containers, pairs, tuples, optionals
+ *        and variants, whose operator== is declared for any element type.
+ * @example is_equality_comparable<vector<int>> == true, but false for a vector of a type without operator==
+ */
+template<typename T>
+struct is_equality_comparable : std::bool_constant<std::equality_comparable<T>>
+{
+};
+
+template<typename T>
+constexpr bool is_equality_comparable_v = is_equality_comparable<std::remove_cv_t<T>>::value;
+
+template<typename T>
+    requires std::ranges::range<T> && (!std::is_same_v<std::remove_cvref_t<std::ranges::range_value_t<T>>, T>)
+struct is_equality_comparable<T>
+    : std::bool_constant<std::equality_comparable<T> &&
+                         is_equality_comparable_v<std::remove_reference_t<std::ranges::range_value_t<T>>>>
+{
+};
+
+template<typename First, typename Second>
+struct is_equality_comparable<std::pair<First, Second>>
+    : std::bool_constant<is_equality_comparable_v<First> && is_equality_comparable_v<Second>>
+{
+};
+
+template<typename... Types>
+struct is_equality_comparable<std::tuple<Types...>> : std::bool_constant<(is_equality_comparable_v<Types> && ...)>
+{
+};
+
+template<typename T>
+struct is_equality_comparable<std::optional<T>> : std::bool_constant<is_equality_comparable_v<T>>
+{
+};
+
+template<typename... Types>
+struct is_equality_comparable<std::variant<Types...>> : std::bool_constant<(is_equality_comparable_v<Types> && ...)>
+{
+};
+
 FLOW_SUBNAMESPACE_END
 
 /**
@@ -102,4 +151,26 @@ template<typename T>
 concept OnlyMoveable = std::is_move_constructible_v<T> && std::is_move_assignable_v<T> &&
                        !(std::is_copy_constructible_v<T> || std::is_copy_assignable_v<T>);
 
+/**
+ * @brief Requires operator== of type to compile, including for the elements it holds
+ */
+template<typename T>
+concept EqualityComparable = type_traits::is_equality_comparable_v<std::remove_cvref_t<T>>;
+
+/**
+ * @brief Requires type to have a std::hash specialisation
+ */
+template<typename T>
+concept Hashable = requires(const T& value) {
+    { std::hash<T>{}(value) } -> std::convertible_to<std::size_t>;
+};
+
+/**
+ * @brief Requires type to be a resizable contiguous container of trivially copyable values, such as a buffer
+ */
+template<typename T>
+concept ByteBuffer = std::ranges::contiguous_range<T> && std::ranges::sized_range<T> &&
+                     std::is_trivially_copyable_v<std::ranges::range_value_t<T>> &&
+                     requires(T& value, std::size_t size) { value.resize(size); };
+
 FLOW_SUBNAMESPACE_END
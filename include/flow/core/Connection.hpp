@@ -5,10 +5,15 @@
 
 #include "Core.hpp"
 #include "IndexableName.hpp"
+#include "NodeData.hpp"
+#include "RunContext.hpp"
 #include "UUID.hpp"
 
 #include <nlohmann/json_fwd.hpp>
 
+#include <atomic>
+#include <cstdint>
+#include <deque>
 #include <memory>
 #include <mutex>
 #include <string_view>
@@ -22,6 +27,53 @@ using json = nlohmann::json;
  */
 using SharedConnection = std::shared_ptr<class Connection>;
 
+class Node;
+
+/**
+ * @brief Data travelling through a connection, tagged with the run that produced it.
+ */
+struct Envelope
+{
+    /// The data being delivered.
+    SharedNodeData Data;
+
+    /// The context of the graph run that produced the data, nullptr if it was produced outside of a run.
+    SharedRunContext Context;
+};
+
+/**
+ * @brief Policy applied when data is pushed onto a connection whose queue is at capacity.
+ */
+enum class OverflowPolicy : std::uint8_t
+{
+    /// The producer delivers queued data itself until space is available, throttling it to the consumer's pace.
+    Block,
+
+    /// The oldest queued data is discarded to make room for the new data.
+    DropOldest,
+
+    /// The new data is discarded, keeping the already queued data.
+    DropNewest,
+};
+
+/**
+ * @brief Result of pushing data onto a connection queue.
+ */
+enum class PushResult : std::uint8_t
+{
+    /// The data was queued and the queue was idle, the caller MUST schedule a drain of the connection.
+    Schedule,
+
+    /// The data was queued behind data that is already scheduled to be drained.
+    Queued,
+
+    /// The data, or the oldest queued data, was discarded due to the overflow policy.
+    Dropped,
+
+    /// The queue is full and the overflow policy is Block, the caller MUST make space and retry.
+    Full,
+};
+
 /**
  * @brief Defines a connection between ports on different nodes.
  *
@@ -48,9 +100,10 @@ class Connection
      * @param start_port_key The Port key of the output port.
      * @param end_node_id The UUID of the node to which data will flow.
      * @param end_port_key The Port key of the input port.
+     * @param consumer The node to which data will flow, if known.
      */
     Connection(const UUID& start_node_id, const IndexableName& start_port_key, const UUID& end_node_id,
-               const IndexableName& end_port_key);
+               const IndexableName& end_port_key, std::weak_ptr<Node> consumer = {});
 
     /**
      * @brief Locks the connection.
@@ -97,12 +150,98 @@ class Connection
      */
     [[nodiscard]] const IndexableName& EndPortKey() const noexcept { return _end_port_key; }
 
+    /**
+     * @brief Gets the node to which data flows.
+     *
+     * @details The node is held by the connection, so that delivering data does not look it up in the graph.
+     *
+     * @returns The receiving node, nullptr if it is unknown or was destroyed.
+     */
+    [[nodiscard]] std::shared_ptr<Node> GetConsumer() const noexcept { return _consumer.lock(); }
+
     /**
      * @brief Get a reference to the UUID of the connection.
      * @returns The UUID of the connection.
      */
     [[nodiscard]] const UUID& ID() const noexcept { return _id; }
 
+    /**
+     * @brief Sets the maximum number of data values that can be queued on the connection.
+     *
+     * @param capacity The maximum queue size, 0 for an unbounded queue.
+     * @param policy The policy to apply when data is pushed onto a full queue.
+     */
+    void SetCapacity(std::size_t capacity, OverflowPolicy policy = OverflowPolicy::Block);
+
+    /**
+     * @brief Gets the maximum number of data values that can be queued on the connection.
+     * @returns The capacity of the queue, 0 if unbounded.
+     */
+    [[nodiscard]] std::size_t GetCapacity() const;
+
+    /**
+     * @brief Gets the policy applied when the queue is full.
+     * @returns The overflow policy of the connection.
+     */
+    [[nodiscard]] OverflowPolicy GetOverflowPolicy() const;
+
+    /**
+     * @brief Gets the number of data values waiting to be delivered.
+     * @returns The current size of the queue.
+     */
+    [[nodiscard]] std::size_t QueueSize() const;
+
+    /**
+     * @brief Gets the number of data values discarded by the overflow policy.
+     * @returns The total count of dropped data values.
+     */
+    [[nodiscard]] std::size_t DroppedCount() const;
+
+    /**
+     * @brief Checks if the connection has no data queued and no drain scheduled.
+     * @returns true if data handed to the input port directly cannot overtake queued data, false otherwise.
+     */
+    [[nodiscard]] bool IsIdle() const;
+
+    /**
+     * @brief Checks if the connection is fused, handing data to its input port on the thread that produced it.
+     * @returns true if the connection is fused, false otherwise.
+     */
+    [[nodiscard]] bool IsFused() const noexcept { return _fused.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Sets if the connection is fused.
+     *
+     * @details Data emitted on a fused connection skips its queue, and the receiving node is computed inline by the
+     *          producer, as long as the depth of nested inline computes stays within Settings::MaxInlineDepth. Bounded
+     *          connections, and connections with queued data, always queue, so that the capacity and order still hold.
+     *
+     * @param fused Flag if the connection should be fused.
+     */
+    void SetFused(bool fused) noexcept { _fused.store(fused, std::memory_order_relaxed); }
+
+    /**
+     * @brief Pushes data onto the queue of the connection, applying the overflow policy if full.
+     *
+     * @param envelope The data to be delivered to the input port.
+     * @param overflow Flag to queue the data beyond the capacity when the policy is Block, for callers that cannot
+     *                 wait for space.
+     *
+     * @returns The result of the push, indicating whether the caller has to schedule a drain or make space.
+     */
+    PushResult Push(Envelope envelope, bool overflow = false);
+
+    /**
+     * @brief Pops the next data value to deliver.
+     *
+     * @details When the queue is empty, the connection is marked as idle so that the next push requests a new drain.
+     *
+     * @param envelope The popped data.
+     *
+     * @returns true if data was popped, false if the queue was empty.
+     */
+    bool Pop(Envelope& envelope);
+
     /**
      * @brief Converts the connection into a JSON object.
      * @returns The constructed JSON object.
@@ -118,6 +257,15 @@ class Connection
   private:
     std::mutex _mutex;
 
+    mutable std::mutex _queue_mutex;
+    std::deque<Envelope> _queue;
+    std::size_t _capacity  = 0;
+    std::size_t _dropped   = 0;
+    OverflowPolicy _policy = OverflowPolicy::Block;
+    bool _scheduled        = false;
+
+    std::atomic<bool> _fused = false;
+
     UUID _id;
 
     UUID _start_node_id;
@@ -125,6 +273,8 @@ class Connection
 
     UUID _end_node_id;
     IndexableName _end_port_key;
+
+    std::weak_ptr<Node> _consumer;
 };
 
 FLOW_NAMESPACE_END
@@ -38,11 +38,12 @@ class Connections
      * @param start_port_key The key of the Port from which the data flows.
      * @param end_id The UUID of the node to which emitted data flows.
      * @param end_port_key The key of the Port to which data flows.
+     * @param consumer The node to which data flows, if known.
      *
      * @returns A reference to the newly created connection.
      */
     SharedConnection& Add(UUID start_id, const IndexableName& start_port_key, UUID end_id,
-                          const IndexableName& end_port_key);
+                          const IndexableName& end_port_key, std::weak_ptr<Node> consumer = {});
 
     /**
      * @brief Remove the connection by its given UUID.
@@ -4,18 +4,35 @@
 #pragma once
 
 #include "Core.hpp"
+#include "Event.hpp"
 #include "NodeFactory.hpp"
+#include "Priority.hpp"
+#include "SpinPool.hpp"
+#include "TimerWheel.hpp"
+#include "Topology.hpp"
 
 #include <BS_thread_pool.hpp>
 
+#include <chrono>
+#include <exception>
+#include <filesystem>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
+#include <vector>
 
 FLOW_NAMESPACE_BEGIN
 
-using thread_pool = BS::thread_pool<>;
+using thread_pool = BS::thread_pool<BS::tp::priority>;
+
+static_assert(std::is_same_v<priority_t, BS::priority_t>);
+static_assert(priority_t(Priority::Background) == BS::pr::lowest);
+static_assert(priority_t(Priority::Normal) == BS::pr::normal);
+static_assert(priority_t(Priority::Realtime) == BS::pr::high);
 
 class Node;
 class NodeFactory;
@@ -23,12 +40,51 @@ class NodeFactory;
 /**
  * @brief Settings for the flow environment.
  *
- * @details Holds configuration options for the Env, such as the maximum number of threads in the thread pool.
+ * @details Holds configuration options for the Env, such as the maximum number of threads in the thread pool, and
+ *          where they run. To keep a graph on one socket of a multi-socket system, run it in an Env bound to the NUMA
+ *          node of that socket. Workers then only run on the cores of that node, and the memory they allocate is
+ *          placed on it by the first-touch policy of the operating system.
  */
 struct Settings
 {
     /// The maximum number of threads in the thread pool.
     std::size_t MaxThreads = 10;
+
+    /// CPUs each worker is pinned to, where worker i uses entry i modulo the number of entries. An entry can be a
+    /// single core, or the cores sharing a cache. Empty to not pin workers, unless NumaNode is set.
+    std::vector<CpuSet> WorkerAffinity;
+
+    /// NUMA node whose cores all workers are pinned to, when WorkerAffinity is empty.
+    std::optional<std::size_t> NumaNode;
+
+    /// Name of the worker threads, followed by the index of the worker. Empty to leave the threads unnamed.
+    std::string ThreadNamePrefix = "flow-worker-";
+
+    /// Number of dedicated workers that run the tasks of the Realtime priority lane. These workers poll for tasks
+    /// instead of sleeping, which avoids the wake-up latency of the thread pool. Zero to run all lanes on the pool.
+    std::size_t SpinWorkers = 0;
+
+    /// How long idle spin workers poll for tasks before parking, or SpinPool::unlimited_spin to busy-poll.
+    std::chrono::nanoseconds SpinBudget = std::chrono::microseconds(100);
+
+    /// Maximum number of nested computes a thread runs inline for fused connections and inline nodes, before queueing
+    /// data instead.
+    std::size_t MaxInlineDepth = 64;
+
+    /// Longest time a producer waits for space on a full connection with OverflowPolicy::Block that is on a cycle,
+    /// before queueing beyond the capacity. Threads that fill a cycle from both ends would otherwise wait on each
+    /// other forever.
+    std::chrono::nanoseconds CycleBlockTimeout = std::chrono::milliseconds(1);
+
+    /// Average compute time up to which nodes with InlinePolicy::Auto are computed inline.
+    std::chrono::nanoseconds InlineThreshold = std::chrono::microseconds(5);
+
+    /// Size of the chunks each thread allocates the node data made during a graph run from, see RunArena. Zero to
+    /// allocate all node data on the heap.
+    std::size_t RunArenaChunkSize = 0;
+
+    /// Directory ports with RetentionPolicy::Spill write their data to. Empty to use the temporary directory.
+    std::filesystem::path SpillDirectory;
 };
 
 /**
@@ -51,8 +107,13 @@ class Env
     /// Type alias for a function that visits a shared node.
     using VisitorFunction = std::function<void(const SharedNode&)>;
 
+    /// Type alias for the identifier of a timer.
+    using TimerID = TimerWheel::TimerID;
+
     Env(const Env&) = delete;
 
+    ~Env();
+
     /**
      * @brief Creator method which constructs only shared pointers.
      *
@@ -72,7 +133,13 @@ class Env
     [[nodiscard]] std::shared_ptr<NodeFactory> GetFactory() const { return _factory; }
 
     /**
-     * @brief Waits for all threads in the pool to dequeue and execute.
+     * @brief Gets the settings the environment was created with.
+     * @returns The settings of the environment.
+     */
+    [[nodiscard]] const Settings& GetSettings() const noexcept { return _settings; }
+
+    /**
+     * @brief Waits for all threads in the pool, and the spin workers, to dequeue and execute.
      */
     void Wait();
 
@@ -90,6 +157,30 @@ class Env
         _pool->detach_task([=] { task(std::forward<Args>(args)...); });
     }
 
+    /**
+     * @brief Add a task to the thread pool queue with a priority.
+     *
+     * @details Queued tasks with a higher priority are dequeued before those with a lower priority. Tasks in the
+     *          Realtime lane run on the spin workers, if there are any.
+     *
+     * @tparam F The task type
+     * @tparam Args Variadic list of argument types for the task.
+     * @param priority The priority of the task, usually a Priority lane plus an offset within the lane.
+     * @param task A function to be executed on a thread from the pool.
+     * @param args Variadic list of arguments for the task.
+     */
+    template<typename F, typename... Args>
+    void AddPriorityTask(priority_t priority, F&& task, Args&&... args)
+    {
+        if (_spin_pool && priority >= priority_t(Priority::Realtime))
+        {
+            _spin_pool->Push([=] { task(args...); });
+            return;
+        }
+
+        _pool->detach_task([=] { task(args...); }, priority);
+    }
+
     /**
      * @brief Add a sequence of tasks to the thread pool queue.
      *
@@ -149,6 +240,45 @@ class Env
             num_blocks);
     }
 
+    /**
+     * @brief Adds a one-shot timer.
+     *
+     * @details The callback is queued on the thread pool once the delay has passed, with the given priority.
+     *
+     * @param delay The time until the timer fires.
+     * @param callback The function to call when the timer fires.
+     * @param priority The priority of the queued callback.
+     *
+     * @returns The identifier of the timer, which can be used to cancel it before it fires.
+     */
+    TimerID AddTimer(std::chrono::microseconds delay, std::function<void()> callback,
+                     priority_t priority = priority_t(Priority::Normal));
+
+    /**
+     * @brief Adds a periodic timer.
+     *
+     * @details The callback is queued on the thread pool every period, with the given priority. Periods are measured
+     *          from the previous expiry, so the timer does not drift, and periods missed entirely are skipped.
+     *
+     * @param period The time between firings of the timer.
+     * @param callback The function to call when the timer fires.
+     * @param priority The priority of the queued callback.
+     *
+     * @returns The identifier of the timer, which can be used to cancel it.
+     */
+    TimerID AddPeriodicTimer(std::chrono::microseconds period, std::function<void()> callback,
+                             priority_t priority = priority_t(Priority::Normal));
+
+    /**
+     * @brief Cancels a timer.
+     *
+     * @note A callback that was already queued on the thread pool still runs.
+     *
+     * @param id The identifier of the timer.
+     * @returns true if the timer was cancelled, false if it had already fired or been cancelled.
+     */
+    bool CancelTimer(TimerID id);
+
     /**
      * @brief Returns a system environment variable value.
      *
@@ -157,12 +287,29 @@ class Env
      */
     [[nodiscard]] std::string GetVar(const std::string& name) const;
 
+  public:
+    /// Event run when a task on the spin workers throws.
+    EventDispatcher<const std::exception&> OnError;
+
+  private:
+    TimerWheel& GetTimers();
+
   private:
+    /// The settings the environment was created with.
+    Settings _settings;
+
     /// The node factory to use for constructing available nodes.
     std::shared_ptr<NodeFactory> _factory;
 
     /// The thread pool to use for executing graphs.
     std::unique_ptr<thread_pool> _pool;
+
+    /// The workers for the Realtime lane, if enabled in the settings.
+    std::unique_ptr<SpinPool> _spin_pool;
+
+    /// The timers queueing tasks on the pool, created on first use.
+    std::unique_ptr<TimerWheel> _timers;
+    std::once_flag _timers_once;
 };
 
 FLOW_NAMESPACE_END
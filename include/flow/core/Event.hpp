@@ -3,11 +3,17 @@
 
 #pragma once
 
+#include "AtomicSharedPtr.hpp"
 #include "Core.hpp"
 #include "IndexableName.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <functional>
-#include <unordered_map>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
 
 FLOW_NAMESPACE_BEGIN
 
@@ -16,12 +22,21 @@ using Event = std::function<void(Args...)>;
 
 /**
  * @brief Dispatches a series of bound events.
+ *
+ * @details Bound events are kept in an immutable list, which is copied on every Bind and Unbind and published
+ *          atomically. Broadcasts never lock, and iterate the list that was published when they started, so events can
+ *          be bound and unbound from any thread while other threads broadcast. An event that is unbound during a
+ *          broadcast can still be called by that broadcast.
+ *
+ *          Dispatchers without bound events cost a single atomic load per broadcast, and no allocation.
+ *
  * @tparam Args The argument types for the event.
  */
 template<class... Args>
 class EventDispatcher
 {
     using EventType = Event<Args...>;
+    using EventList = std::vector<std::pair<IndexableName, EventType>>;
 
   public:
     /**
@@ -33,19 +48,74 @@ class EventDispatcher
      * @param name The unique identifier of the event to be bound.
      * @param event The event to be bound.
      */
-    void Bind(IndexableName name, EventType&& event) noexcept { _events.emplace(name, std::move(event)); }
+    void Bind(IndexableName name, EventType&& event) noexcept
+    {
+        const auto is_bound = [&](const auto& entry) { return entry.first == name; };
+        const bool bound    = Update([&](const EventList* events, EventList& updated) {
+            if (events && std::any_of(events->begin(), events->end(), is_bound))
+            {
+                return false;
+            }
+
+            if (events)
+            {
+                updated.reserve(events->size() + 1);
+                updated.assign(events->begin(), events->end());
+            }
+
+            // Copied, since the update is retried when another thread published first.
+            updated.emplace_back(name, event);
+            return true;
+        });
+
+        if (bound)
+        {
+            _count.fetch_add(1, std::memory_order_release);
+        }
+    }
 
     /**
      * @brief Unbinds an event by name.
      *
      * @param name The name fo the event being unbound.
      */
-    void Unbind(IndexableName name) { _events.erase(name); }
+    void Unbind(IndexableName name)
+    {
+        const auto is_bound = [&](const auto& entry) { return entry.first == name; };
+        const bool unbound  = Update([&](const EventList* events, EventList& updated) {
+            if (!events || std::none_of(events->begin(), events->end(), is_bound))
+            {
+                return false;
+            }
+
+            updated.reserve(events->size() - 1);
+            std::remove_copy_if(events->begin(), events->end(), std::back_inserter(updated), is_bound);
+            return true;
+        });
+
+        if (unbound)
+        {
+            _count.fetch_sub(1, std::memory_order_release);
+        }
+    }
 
     /**
      * @brief Unbinds all events from the dispatcher.
      */
-    void UnbindAll() { _events.clear(); }
+    void UnbindAll()
+    {
+        auto events = _events.exchange(nullptr);
+        if (events)
+        {
+            _count.fetch_sub(events->size(), std::memory_order_release);
+        }
+    }
+
+    /**
+     * @brief Check if any event is bound.
+     * @returns true if the dispatcher has bound events, false otherwise.
+     */
+    [[nodiscard]] bool HasSubscribers() const noexcept { return _count.load(std::memory_order_acquire) != 0; }
 
     /**
      * @brief Broadcasts the given arguments to all bound events.
@@ -54,15 +124,57 @@ class EventDispatcher
      */
     void Broadcast(Args&&... args) const
     {
-        for (const auto& [_, event] : _events)
+        if (!HasSubscribers())
+        {
+            return;
+        }
+
+        const auto events = _events.load();
+        if (!events)
+        {
+            return;
+        }
+
+        for (const auto& [_, event] : *events)
         {
             event(std::forward<Args>(args)...);
         }
     }
 
   private:
-    /// Keyed list of bound events.
-    std::unordered_map<IndexableName, EventType> _events;
+    /**
+     * @brief Publishes a modified copy of the bound events, retrying when another thread published first.
+     *
+     * @param modify Function filling the updated list from the current one, which may be null. Returns false to leave
+     *               the current list unchanged.
+     *
+     * @returns true if an updated list was published, false if modify left the list unchanged.
+     */
+    template<typename F>
+    bool Update(F&& modify)
+    {
+        auto current = _events.load();
+        while (true)
+        {
+            auto updated = std::make_shared<EventList>();
+            if (!modify(current.get(), *updated))
+            {
+                return false;
+            }
+
+            if (_events.compare_exchange(current, updated->empty() ? nullptr : std::move(updated)))
+            {
+                return true;
+            }
+        }
+    }
+
+  private:
+    /// Keyed list of bound events, null until an event is bound.
+    AtomicSharedPtr<const EventList> _events;
+
+    /// Number of bound events, checked before loading the list.
+    std::atomic<std::size_t> _count = 0;
 };
 
 FLOW_NAMESPACE_END
@@ -3,12 +3,21 @@
 
 #pragma once
 
+#include "Column.hpp"
 #include "Env.hpp"
 #include "Node.hpp"
 #include "NodeFactory.hpp"
+#include "ResultCache.hpp"
 
 #include <nlohmann/json.hpp>
 
+#include <atomic>
+#include <concepts>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <variant>
 #include <vector>
 
 FLOW_NAMESPACE_BEGIN
@@ -43,6 +52,14 @@ struct FunctionTraits<R(Args...)>
  *          - Output port named "return" for the return value
  *          - Reference parameters become output ports
  *
+ *          Nodes of pure functions can share a result cache, which is enabled with SetCacheBudget. Cached results are
+ *          keyed by a hash of the input values, using the hash registered for the input type in the NodeFactory, or
+ *          std::hash. Inputs without either are not cached.
+ *
+ *          Functions taking their arguments by value or const reference support batches, calling the function for each
+ *          record of the input columns. Inputs holding a single value are broadcast to every record, and records that
+ *          are null in any input column are null in the returned column.
+ *
  * @tparam F Function type (e.g., int(float, bool))
  * @tparam Func Pointer to concrete function implementation
  */
@@ -70,6 +87,47 @@ class FunctionNode : public Node
     template<std::size_t Idx>
     using arg_t = typename std::tuple_element_t<Idx, arg_ts>;
 
+    /// Helper to get the tuple of input values that key the result cache
+    template<typename Tuple>
+    struct cache_key;
+
+    template<typename... Types>
+    struct cache_key<std::tuple<Types...>>
+    {
+        using type = std::tuple<std::remove_cvref_t<Types>...>;
+
+        /// Results can only be cached when no argument is an output, and all values can be copied into the cache and
+        /// compared with the cached keys, so that a hash collision never returns the result of other inputs.
+        static constexpr bool cacheable =
+            ((!std::is_lvalue_reference_v<Types> || std::is_const_v<std::remove_reference_t<Types>>) && ...) &&
+            (std::is_copy_constructible_v<std::remove_cvref_t<Types>> && ...) &&
+            (concepts::EqualityComparable<Types> && ...);
+    };
+
+    using cache_key_t   = typename cache_key<arg_ts>::type;
+    using cache_value_t = std::conditional_t<std::is_void_v<output_t>, std::monostate, std::remove_cvref_t<output_t>>;
+
+    /// Flag if the results of the function can be cached
+    static constexpr bool cacheable =
+        !std::is_void_v<output_t> && cache_key<arg_ts>::cacheable && std::is_copy_constructible_v<cache_value_t>;
+
+    /// Helper to check that every value can be stored in a column
+    template<typename Tuple>
+    struct column_values;
+
+    template<typename... Types>
+    struct column_values<std::tuple<Types...>>
+    {
+        static constexpr bool value =
+            ((!std::is_reference_v<Types> || std::is_const_v<std::remove_reference_t<Types>>) && ...) &&
+            (std::default_initializable<std::remove_cvref_t<Types>> && ...) &&
+            (!std::same_as<std::remove_cvref_t<Types>, bool> && ...);
+    };
+
+    /// Flag if the function can be called for each record of a batch
+    static constexpr bool batchable = !std::is_void_v<output_t> && column_values<std::tuple<output_t>>::value &&
+                                      column_values<arg_ts>::value;
+
     /// Name of the return value output port
     static constexpr const char* return_output_name = "return";
 
@@ -125,6 +183,146 @@ class FunctionNode : public Node
         }()...);
     }
 
+    template<typename Inputs>
+    cache_value_t Call(const Inputs& inputs)
+    {
+        return std::apply([&](auto&&... args) { return _func(args->Get()...); }, inputs);
+    }
+
+    template<typename Inputs>
+    auto CachedCall(const Inputs& inputs)
+    {
+        constexpr auto indices = std::make_integer_sequence<int, std::tuple_size_v<arg_ts>>{};
+
+        const auto hash = HashInputs(inputs, indices);
+        if (!hash)
+        {
+            auto result = Call(inputs);
+            return MakeNodeData(std::move(result));
+        }
+
+        if (auto cached = _cache.Find(*hash, [&](const cache_key_t& key) { return InputsEqual(key, inputs, indices); }))
+        {
+            return MakeNodeData(std::move(*cached));
+        }
+
+        // Copy the key before calling, since the function may move from its inputs.
+        auto key    = MakeCacheKey(inputs, indices);
+        auto result = Call(inputs);
+        _cache.Insert(*hash, std::move(key), result);
+        return MakeNodeData(std::move(result));
+    }
+
+    template<typename Inputs, int... Idx>
+    std::optional<std::size_t> HashInputs(const Inputs& inputs, std::integer_sequence<int, Idx...>) const
+    {
+        std::size_t seed = 0;
+        if (!(HashInput<Idx>(std::as_const(*std::get<Idx>(inputs)).Get(), seed) && ...))
+        {
+            return std::nullopt;
+        }
+
+        return seed;
+    }
+
+    template<int Idx, typename T>
+    bool HashInput(const T& value, std::size_t& seed) const
+    {
+        using value_t = std::remove_cvref_t<arg_t<Idx>>;
+
+        std::size_t hash = 0;
+        if (const auto registered = GetEnv()->GetFactory()->GetHash(TypeName_v<value_t>))
+        {
+            hash = (*registered)(&value);
+        }
+        else if constexpr (concepts::Hashable<value_t>)
+        {
+            hash = std::hash<value_t>{}(value);
+        }
+        else
+        {
+            return false;
+        }
+
+        seed ^= hash + 0x9e3779b97f4a7c15 + (seed << 12) + (seed >> 4);
+        return true;
+    }
+
+    template<typename Inputs, int... Idx>
+    static bool InputsEqual(const cache_key_t& key, const Inputs& inputs, std::integer_sequence<int, Idx...>)
+    {
+        return ((std::get<Idx>(key) == std::as_const(*std::get<Idx>(inputs)).Get()) && ...);
+    }
+
+    template<typename Inputs, int... Idx>
+    static cache_key_t MakeCacheKey(const Inputs& inputs, std::integer_sequence<int, Idx...>)
+    {
+        return cache_key_t{std::as_const(*std::get<Idx>(inputs)).Get()...};
+    }
+
+    template<int Idx>
+    auto GetBatchInput()
+    {
+        using value_t = std::remove_cvref_t<arg_t<Idx>>;
+
+        const auto& data = GetInputData(IndexableName{_arg_names[Idx]});
+        return std::make_pair(CastNodeData<Column<value_t>>(data),
+                              GetEnv()->GetFactory()->template Convert<value_t>(data));
+    }
+
+    template<int Idx, typename Inputs>
+    static const auto& GetRecord(const Inputs& inputs, std::size_t i)
+    {
+        const auto& [column, value] = std::get<Idx>(inputs);
+        return column ? std::as_const(*column).Get()[i] : std::as_const(*value).Get();
+    }
+
+    template<int... Idx>
+    void ComputeBatch(std::integer_sequence<int, Idx...>)
+    {
+        const auto inputs = std::make_tuple(GetBatchInput<Idx>()...);
+
+        std::optional<std::size_t> size;
+        bool missing = false;
+        (
+            [&] {
+                const auto& [column, value] = std::get<Idx>(inputs);
+                if (!column)
+                {
+                    missing |= !value;
+                    return;
+                }
+
+                const auto column_size = std::as_const(*column).Get().Size();
+                if (size && *size != column_size)
+                {
+                    throw std::invalid_argument("column of argument " + _arg_names[Idx] + " has " +
+                                                std::to_string(column_size) + " records, expected " +
+                                                std::to_string(*size));
+                }
+
+                size = column_size;
+            }(),
+            ...);
+
+        if (missing || !size)
+        {
+            return;
+        }
+
+        Column<cache_value_t> result(*size);
+        for (std::size_t i = 0; i < *size; ++i)
+        {
+            const bool valid = ((!std::get<Idx>(inputs).first || std::get<Idx>(inputs).first->IsValid(i)) && ...);
+            if (valid)
+            {
+                result.Set(i, _func(GetRecord<Idx>(inputs, i)...));
+            }
+        }
+
+        this->SetOutputData(return_output_name, MakeNodeData(std::move(result)));
+    }
+
     template<int... Idx>
     json SaveInputs(std::integer_sequence<int, Idx...>) const
     {
@@ -191,6 +389,47 @@ class FunctionNode : public Node
 
     virtual ~FunctionNode() = default;
 
+    /**
+     * @brief Set the memory budget of the result cache shared by all nodes of this class.
+     *
+     * @note MUST only be used for pure functions, whose result only depends on the values of their inputs.
+     *
+     * @param bytes The budget in bytes, or zero to disable and clear the cache.
+     */
+    static void SetCacheBudget(std::size_t bytes)
+    {
+        static_assert(cacheable, "results of functions with output arguments, void return, or non-copyable or "
+                                 "non-comparable values cannot be cached");
+        _cache.SetBudget(bytes);
+    }
+
+    /**
+     * @brief Get the memory budget of the result cache shared by all nodes of this class.
+     * @returns The budget in bytes, where zero means that the cache is disabled.
+     */
+    [[nodiscard]] static std::size_t GetCacheBudget() { return _cache.GetBudget(); }
+
+    /**
+     * @brief Get the hit and miss statistics of the result cache shared by all nodes of this class.
+     * @returns A snapshot of the cache statistics.
+     */
+    [[nodiscard]] static CacheStats GetCacheStats() { return _cache.GetStats(); }
+
+    /**
+     * @brief Removes all cached results of this class, and resets the statistics.
+     */
+    static void ClearCache() { _cache.Clear(); }
+
+    /**
+     * @brief Marks the function of this class as pure, whose result only depends on the values of its inputs.
+     * @param pure Flag if the function is pure.
+     */
+    static void SetPure(bool pure) noexcept { _pure = pure; }
+
+    [[nodiscard]] bool IsPure() const noexcept override { return _pure; }
+
+    [[nodiscard]] bool SupportsBatch() const noexcept override { return batchable; }
+
   protected:
     void Compute() override
     {
@@ -201,24 +440,55 @@ class FunctionNode : public Node
             return;
         }
 
+        const Port* unchanged_port = nullptr;
         if constexpr (std::is_void_v<output_t>)
         {
             std::apply([&](auto&&... args) { return _func(args->Get()...); }, inputs);
         }
         else
         {
-            auto result = std::apply([&](auto&&... args) { return _func(args->Get()...); }, inputs);
-            this->SetOutputData(return_output_name, MakeNodeData(std::move(result)), false);
+            auto result_data = [&] {
+                if constexpr (cacheable)
+                {
+                    if (_cache.GetBudget() != 0)
+                    {
+                        return CachedCall(inputs);
+                    }
+                }
+
+                auto result = Call(inputs);
+                return MakeNodeData(std::move(result));
+            }();
+            if (const auto& port = GetOutputPort(return_output_name); port->IsUnchanged(result_data))
+            {
+                unchanged_port = port.get();
+            }
+            this->SetOutputData(return_output_name, std::move(result_data), false);
         }
 
         const auto& outputs = GetOutputPorts();
         for (const auto& [key, port] : outputs)
         {
             OnSetOutput.Broadcast(key, port->GetData());
+
+            // Reference arguments are modified in place, so only the returned value can be compared.
+            if (port.get() == unchanged_port)
+            {
+                continue;
+            }
+
             EmitUpdate(key, port->GetData());
         }
     }
 
+    void ComputeBatch() override
+    {
+        if constexpr (batchable)
+        {
+            ComputeBatch(std::make_integer_sequence<int, std::tuple_size_v<arg_ts>>{});
+        }
+    }
+
     json SaveInputs() const override
     {
         return SaveInputs(std::make_integer_sequence<int, std::tuple_size_v<arg_ts>>{});
@@ -232,6 +502,8 @@ class FunctionNode : public Node
   private:
     std::add_pointer_t<std::remove_pointer_t<F>> _func;
     static inline std::array<std::string, std::tuple_size_v<arg_ts>> _arg_names{""};
+    static inline ResultCache<cache_key_t, cache_value_t> _cache;
+    static inline std::atomic<bool> _pure = false;
     decayed_tuple_t<arg_ts> _arguments;
 };
 
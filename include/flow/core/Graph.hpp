@@ -8,12 +8,19 @@
 #include "Event.hpp"
 #include "IndexableName.hpp"
 #include "Node.hpp"
+#include "Priority.hpp"
+#include "RunContext.hpp"
 
 #include <nlohmann/json_fwd.hpp>
 
+#include <atomic>
+#include <cstdint>
 #include <mutex>
+#include <optional>
+#include <stop_token>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 FLOW_NAMESPACE_BEGIN
@@ -46,10 +53,130 @@ class Graph
      * @brief Runs compute on the source nodes of the graph, starting the flow.
      *
      * @details Finds all of the source nodes of the graph, and runs compute. The compute of the source nodes will then
-     *          propagate through the rest of the graph and execute the entire flow.
+     *          propagate through the rest of the graph and execute the entire flow. Each run is given an increasing
+     *          sequence number that is carried with all data it propagates.
      */
     void Run();
 
+    /**
+     * @brief Runs compute on the source nodes of the graph, with cancellation and an optional deadline.
+     *
+     * @details Once a stop is requested on the token or the deadline has passed, the remaining tasks of the run are
+     *          skipped, and data produced by the run is no longer propagated. Nodes can poll for cancellation within
+     *          their Compute method to stop early.
+     *
+     * @param token The token used to request cancellation of the run.
+     * @param deadline The point in time after which the run is cancelled, if any.
+     */
+    void Run(std::stop_token token, std::optional<RunContext::clock::time_point> deadline = std::nullopt);
+
+    /**
+     * @brief Computes the data of an output port on demand, pulling data through the graph.
+     *
+     * @details Only the nodes upstream of the requested port are computed, on the calling thread, in topological
+     *          order. Data is pulled along the connections instead of being pushed, so nothing downstream of the
+     *          requested port is computed. A node is only computed again if it is dirty, or an output port it is
+     *          connected to emitted a new version since its data was last pulled, so that clean upstream results are
+     *          reused between evaluations.
+     *
+     *          The nodes of a cycle are computed once per evaluation, after all nodes upstream of the cycle. A
+     *          connection that closes the cycle delivers the data its source had before the evaluation, so feedback
+     *          takes effect one evaluation later, like a delay.
+     *
+     * @param id The UUID of the node owning the output port.
+     * @param key The key of the output port.
+     *
+     * @returns The data of the output port after evaluation.
+     * @throws std::invalid_argument if the node is not in the graph.
+     * @throws std::out_of_range if the node has no output port with the given key.
+     */
+    SharedNodeData Evaluate(const UUID& id, const IndexableName& key);
+
+    /**
+     * @brief Computes the data of several output ports on demand, computing their shared upstream nodes once.
+     *
+     * @param outputs The UUIDs of the nodes and the keys of the output ports to compute.
+     *
+     * @returns The data of each output port after evaluation, in the order they were requested.
+     * @throws std::invalid_argument if a node is not in the graph.
+     * @throws std::out_of_range if a node has no output port with the given key.
+     */
+    std::vector<SharedNodeData> Evaluate(const std::vector<std::pair<UUID, IndexableName>>& outputs);
+
+    /**
+     * @brief Sets data on an input port of a node without computing it, marking the node for the next Recompute.
+     *
+     * @details Intended for edits, where several inputs can be changed before the affected nodes are computed once.
+     *
+     * @param id The UUID of the node.
+     * @param key The key of the input port.
+     * @param data The data to set.
+     *
+     * @throws std::invalid_argument if the node is not in the graph.
+     * @throws std::out_of_range if the node has no input port with the given key.
+     */
+    void SetInputData(const UUID& id, const IndexableName& key, SharedNodeData data);
+
+    /**
+     * @brief Marks a node for the next Recompute, for nodes whose outputs depend on state outside of their inputs.
+     * @param id The UUID of the node.
+     * @throws std::invalid_argument if the node is not in the graph.
+     */
+    void Invalidate(const UUID& id);
+
+    /**
+     * @brief Incrementally recomputes the nodes affected by edits since the last recompute.
+     *
+     * @details Only the nodes downstream of edited nodes are considered, and each is computed at most once, in
+     *          topological order, on the calling thread. Data is pulled from the outputs of upstream nodes as they
+     *          are, so clean results are reused. A downstream node is skipped if none of the outputs it is connected
+     *          to emitted a new version, such as when change detection found the recomputed value unchanged. Cycles
+     *          are computed once, as in Evaluate.
+     *
+     * @returns The number of nodes that were computed.
+     */
+    std::size_t Recompute();
+
+    /**
+     * @brief Get the priority lane for the tasks of nodes that do not set their own.
+     * @returns The priority lane of the graph.
+     */
+    [[nodiscard]] Priority GetPriority() const noexcept { return _priority.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Set the priority lane for the tasks of nodes that do not set their own.
+     * @param priority The new priority lane of the graph.
+     */
+    void SetPriority(Priority priority) noexcept { _priority.store(priority, std::memory_order_relaxed); }
+
+    /**
+     * @brief Get the mode used to assign priorities to tasks within their lane.
+     * @returns The priority mode of the graph.
+     */
+    [[nodiscard]] PriorityMode GetPriorityMode() const noexcept
+    {
+        return _priority_mode.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Set the mode used to assign priorities to tasks within their lane.
+     * @param mode The new priority mode of the graph.
+     */
+    void SetPriorityMode(PriorityMode mode) noexcept { _priority_mode.store(mode, std::memory_order_relaxed); }
+
+    /**
+     * @brief Get the number of connections on the longest path from a node to a leaf.
+     * @param id The UUID of the node.
+     * @returns The length of the longest remaining path from the node.
+     */
+    [[nodiscard]] std::size_t GetRemainingPathLength(const UUID& id) const;
+
+    /**
+     * @brief Get the sequence number of the graph run being executed on the calling thread.
+     * @returns The current run sequence number, 0 if the calling thread is not executing a run.
+     */
+    [[nodiscard]] static std::uint64_t CurrentSequence() noexcept;
+
     /**
      * @brief Visits each node int he graph breadth-wise.
      * @param visitor The visitor function to run when visiting each node.
@@ -140,10 +267,20 @@ class Graph
      */
     [[nodiscard]] std::vector<SharedNode> GetOrphanNodes() const;
 
+    /**
+     * @brief Estimates the memory held by the data retained in the ports of all nodes.
+     *
+     * @details Data shared by several ports, such as an output and the inputs it was delivered to, is only counted
+     *          once. Data waiting in the queues of connections, and spilled data, is not counted.
+     *
+     * @returns The estimated number of bytes, as reported by INodeData::SizeInBytes.
+     */
+    [[nodiscard]] std::size_t MemoryUsage() const;
+
     /**
      * @brief Removes all connections and nodes from the graph.
      */
-    void Clear() noexcept { _connections.Clear(), _nodes.clear(); }
+    void Clear() noexcept { _connections.Clear(), _nodes.clear(), _path_lengths_dirty = true; }
 
     /**
      * @brief Check if the nodes can be connected
@@ -178,6 +315,12 @@ class Graph
     /**
      * @brief Propagates data through the connections of the given ID.
      *
+     * @details Data is pushed onto the queue of each connection, and a drain of the queue is scheduled when it was
+     *          idle. The receiving nodes of fused connections, and nodes whose inline policy allows it, are instead
+     *          computed on the calling thread. When a bounded connection is full and its policy is
+     *          OverflowPolicy::Block, the calling thread delivers queued data itself until there is space, so that
+     *          producers feel the backpressure of slow consumers.
+     *
      * @param id The ID of the connection where the data came from.
      * @param key The name of the port from which data is flowing.
      * @param data The data to propagate.
@@ -230,6 +373,107 @@ class Graph
     /// Event run on Graph when a connection is removed.
     EventDispatcher<const SharedConnection&> OnNodesDisconnected;
 
+  private:
+    /**
+     * @brief Delivers the next queued data value of a connection to its input port.
+     *
+     * @param conn The connection to deliver data from.
+     * @param wait Flag if the receiving node may be waited on. Otherwise nothing is delivered while the node is locked,
+     *             by the calling thread or another one.
+     *
+     * @returns true if data was delivered, false if the queue of the connection was empty or the node is locked.
+     */
+    bool DeliverNext(const SharedConnection& conn, bool wait = true);
+
+    /**
+     * @brief Sets data on the input port of a connection and computes the receiving node on the calling thread, if
+     *        the connection is fused or the inline policy of the node allows it.
+     *
+     * @param conn The connection to deliver data through.
+     * @param node The node receiving the data.
+     * @param data The data to deliver.
+     *
+     * @returns true if the data was delivered, false if it has to be queued because the node is not computed inline,
+     *          the inline depth limit was reached, the receiving node does not queue its inputs, or it is locked, or
+     *          because the connection is bounded or still has queued data to deliver first.
+     */
+    bool DeliverInline(const SharedConnection& conn, const SharedNode& node, const SharedNodeData& data);
+
+    /**
+     * @brief Sets the pending data of a conflating node on its input ports, and computes it once.
+     * @param node The conflating node to compute.
+     */
+    static void ComputePendingInputs(const SharedNode& node);
+
+    /**
+     * @brief Adds a task for a node to the Env, with the priority of the node.
+     * @param node The node the task runs.
+     * @param task The task to run.
+     */
+    void Schedule(const Node& node, std::function<void()> task);
+
+    /**
+     * @brief Gets the task priority of a node from its lane and the priority mode of the graph.
+     *
+     * @details Reads the path length cached on the node, so that only a change of the topology takes the nodes mutex.
+     *
+     * @param node The node.
+     * @returns The task priority for the node.
+     */
+    [[nodiscard]] priority_t GetTaskPriority(const Node& node) const;
+
+    /**
+     * @brief Recomputes the remaining path lengths, the cycles, the topological order and the input connections of all
+     *        nodes if the topology changed, and caches the path length of each node on the node. Requires the nodes
+     *        mutex.
+     *
+     * @details The nodes of a cycle share the longest remaining path of the cycle.
+     */
+    void UpdatePathLengths() const;
+
+    /**
+     * @brief Checks if a connection closes a cycle, so that its consumer can reach its producer.
+     * @param conn The connection.
+     * @returns true if both ends of the connection are on a cycle together, false otherwise.
+     */
+    [[nodiscard]] bool IsOnCycle(const Connection& conn) const;
+
+    /**
+     * @brief A node to be computed by a pull evaluation, along with the connections into its input ports.
+     */
+    struct EvaluationStep
+    {
+        SharedNode Node;
+        std::vector<std::pair<SharedConnection, SharedNode>> Inputs;
+    };
+
+    /**
+     * @brief Gets the given nodes and all nodes upstream or downstream of them, in topological order.
+     * @param ids The UUIDs of the nodes to evaluate.
+     * @param upstream Flag if the nodes upstream of the given nodes are collected, otherwise the nodes downstream.
+     * @returns The steps of the evaluation, where each node comes after all of the nodes it pulls data from, except
+     *          along connections that close a cycle.
+     */
+    [[nodiscard]] std::vector<EvaluationStep> GetEvaluationSteps(const std::vector<UUID>& ids, bool upstream) const;
+
+    /**
+     * @brief Pulls data into the input ports of each node in order, and computes the nodes that are out of date.
+     * @param steps The nodes to evaluate, in topological order.
+     * @returns The number of nodes that were computed.
+     */
+    std::size_t EvaluateSteps(const std::vector<EvaluationStep>& steps);
+
+    /**
+     * @brief Buffers sequenced data for an ordered node, and computes all sequences that are complete in order.
+     *
+     * @param node The ordered node receiving the data. MUST be locked by the caller.
+     * @param key The key of the input port receiving the data.
+     * @param data The converted data.
+     * @param context The context of the run that produced the data.
+     */
+    static void DeliverOrdered(const SharedNode& node, const IndexableName& key, SharedNodeData data,
+                               SharedRunContext context);
+
   protected:
     /// Mutex for thread-safe node operations
     mutable std::mutex _nodes_mutex;
@@ -248,6 +492,37 @@ class Graph
 
     /// Map of node UUIDs to node instances
     std::unordered_map<UUID, SharedNode> _nodes;
+
+    /// Sequence number of the last run
+    std::atomic<std::uint64_t> _run_sequence = 0;
+
+    /// Priority lane for nodes that do not set their own, read by the tasks scheduling nodes
+    std::atomic<Priority> _priority = Priority::Normal;
+
+    /// Mode used to assign priorities within a lane, read by the tasks scheduling nodes
+    std::atomic<PriorityMode> _priority_mode = PriorityMode::Fixed;
+
+    /// Longest remaining path to a leaf for each node, computed lazily
+    mutable std::unordered_map<UUID, std::size_t> _path_lengths;
+
+    /// Strongly connected component of each node, computed lazily with the path lengths. Nodes share a component
+    /// exactly when they are on a cycle together.
+    mutable std::unordered_map<UUID, std::size_t> _components;
+
+    /// Position of each node in a topological order of the components, computed lazily with the path lengths
+    mutable std::unordered_map<UUID, std::size_t> _topological_order;
+
+    /// Connections into the input ports of each node, computed lazily with the path lengths
+    mutable std::unordered_multimap<UUID, SharedConnection> _input_connections;
+
+    /// Flag set when the topology changed since the path lengths were computed
+    mutable std::atomic<bool> _path_lengths_dirty = true;
+
+    /// Mutex for the nodes edited since the last recompute
+    std::mutex _edited_mutex;
+
+    /// Nodes edited since the last recompute
+    std::vector<UUID> _edited_nodes;
 };
 
 FLOW_NAMESPACE_END
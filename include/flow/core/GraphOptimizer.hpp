@@ -0,0 +1,237 @@
+// Copyright (c) 2024, Cisco Systems, Inc.
+// All rights reserved.
+
+#pragma once
+
+#include "Core.hpp"
+#include "Graph.hpp"
+#include "IndexableName.hpp"
+#include "UUID.hpp"
+
+#include <concepts>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+FLOW_NAMESPACE_BEGIN
+
+/**
+ * @brief Describes what an optimization pass changed in a graph.
+ */
+struct OptimizationReport
+{
+    /// Name of the pass that made the changes
+    std::string Pass;
+
+    /// UUIDs of the nodes removed from the graph
+    std::vector<UUID> RemovedNodes;
+
+    /// Human readable description of each change
+    std::vector<std::string> Changes;
+};
+
+/**
+ * @brief Interface of a pass that transforms a graph before execution, without changing the results of its run.
+ *
+ * @details Passes keep the nodes of observed output ports, which are read outside of the graph, so that the data read
+ *          from them is still computed after the graph was optimized.
+ */
+class GraphPass
+{
+  public:
+    /// UUIDs of nodes and keys of their output ports that are read outside of the graph
+    using ObservedPorts = std::vector<std::pair<UUID, IndexableName>>;
+
+    /**
+     * @brief Constructs the pass.
+     * @param observed The UUIDs of the nodes and the keys of the output ports that are read outside of the graph.
+     */
+    explicit GraphPass(ObservedPorts observed = {}) : _observed{std::move(observed)} {}
+
+    virtual ~GraphPass() = default;
+
+    /**
+     * @brief Get the name of the pass, used in its reports.
+     * @returns The name of the pass.
+     */
+    [[nodiscard]] virtual std::string_view GetName() const noexcept = 0;
+
+    /**
+     * @brief Runs the pass over the graph.
+     * @param graph The graph to transform.
+     * @param report The report to add the changes of the pass to.
+     */
+    virtual void Run(Graph& graph, OptimizationReport& report) = 0;
+
+  protected:
+    /**
+     * @brief Get the output ports that are read outside of the graph.
+     * @returns The UUIDs of the nodes and the keys of their observed output ports.
+     */
+    [[nodiscard]] const ObservedPorts& GetObserved() const noexcept { return _observed; }
+
+    /**
+     * @brief Checks if any output port of a node is read outside of the graph.
+     * @param id The UUID of the node.
+     * @returns true if the node has an observed output port, false otherwise.
+     */
+    [[nodiscard]] bool IsObserved(const UUID& id) const;
+
+  private:
+    ObservedPorts _observed;
+};
+
+/**
+ * @brief Moves the nodes of subgraph nodes in SubgraphMode::Flattened into the parent graph.
+ *
+ * @details The connections inside of the subgraph are recreated in the parent graph, and the connections to the
+ *          exposed ports of the subgraph node are rewired to the inner ports. Constant data on unconnected exposed
+ *          inputs is set on the inner ports. Flattened subgraphs nested in the moved nodes are flattened as well. The
+ *          wrapped graph is left empty. Observed subgraph nodes are not flattened, since their exposed outputs are
+ *          read outside of the graph.
+ */
+class SubgraphFlattening : public GraphPass
+{
+  public:
+    using GraphPass::GraphPass;
+
+    [[nodiscard]] std::string_view GetName() const noexcept override { return "SubgraphFlattening"; }
+
+    void Run(Graph& graph, OptimizationReport& report) override;
+};
+
+/**
+ * @brief Removes nodes whose outputs reach no leaf or observed port.
+ *
+ * @details Leaves are nodes without output ports, which are assumed to have side effects. Every node that is not
+ *          upstream of a leaf, or of an observed output port, is removed, such as branches whose results are never
+ *          used.
+ *
+ * @note Nodes that are only kept for their side effects, or whose outputs are read outside of the graph, MUST have
+ *       one of their output ports observed.
+ */
+class DeadNodeElimination : public GraphPass
+{
+  public:
+    using GraphPass::GraphPass;
+
+    [[nodiscard]] std::string_view GetName() const noexcept override { return "DeadNodeElimination"; }
+
+    void Run(Graph& graph, OptimizationReport& report) override;
+};
+
+/**
+ * @brief Computes pure nodes whose inputs are all constants ahead of time.
+ *
+ * @details A pure node qualifies when none of its input ports are connected and all of them hold data, such as values
+ *          restored with RestoreInputs. The computed outputs are set as constant inputs on the connected nodes, and the
+ *          folded node is removed, which can in turn make the downstream nodes foldable.
+ *
+ *          Nodes with reference outputs are not folded, since their data lives in the node. Observed nodes are not
+ *          folded, since their outputs are read outside of the graph.
+ */
+class ConstantFolding : public GraphPass
+{
+  public:
+    using GraphPass::GraphPass;
+
+    [[nodiscard]] std::string_view GetName() const noexcept override { return "ConstantFolding"; }
+
+    void Run(Graph& graph, OptimizationReport& report) override;
+};
+
+/**
+ * @brief Merges identical pure nodes with identical inputs.
+ *
+ * @details Pure nodes of the same class are merged when each of their input ports is connected to the same output
+ *          port, or holds an equal constant. The connections of the merged node are moved to the node it is merged
+ *          into. Nodes are visited in topological order, so that merging upstream nodes exposes downstream duplicates.
+ *
+ *          Constants of types without operator== are only equal if they are the same data. Observed nodes are kept,
+ *          and only other nodes are merged into them.
+ */
+class CommonSubexpressionElimination : public GraphPass
+{
+  public:
+    using GraphPass::GraphPass;
+
+    [[nodiscard]] std::string_view GetName() const noexcept override { return "CommonSubexpressionElimination"; }
+
+    void Run(Graph& graph, OptimizationReport& report) override;
+};
+
+/**
+ * @brief Fuses single-producer, single-consumer chains so that each chain runs as one task.
+ *
+ * @details A connection is fused when it is the only connection out of its producer, and the only connected input of
+ *          its consumer. The consumer is then computed inline by the producer, with the data handed across directly
+ *          instead of through the queue of the connection and a separate pool task. Consumers that conflate or order
+ *          their inputs, bounded connections, and connections on a cycle are not fused.
+ */
+class NodeFusion : public GraphPass
+{
+  public:
+    using GraphPass::GraphPass;
+
+    [[nodiscard]] std::string_view GetName() const noexcept override { return "NodeFusion"; }
+
+    void Run(Graph& graph, OptimizationReport& report) override;
+};
+
+/**
+ * @brief Runs a pipeline of passes over a graph before execution.
+ */
+class GraphOptimizer
+{
+  public:
+    GraphOptimizer() = default;
+
+    /**
+     * @brief Creates an optimizer with subgraph flattening, constant folding, common subexpression elimination, dead
+     *        node elimination and node fusion.
+     * @param observed The UUIDs of the nodes and the keys of the output ports that are read outside of the graph.
+     * @returns The optimizer with the default passes.
+     */
+    static GraphOptimizer CreateDefault(GraphPass::ObservedPorts observed = {});
+
+    /**
+     * @brief Adds a pass to the end of the pipeline.
+     * @param pass The pass to add.
+     */
+    void AddPass(std::unique_ptr<GraphPass> pass);
+
+    /**
+     * @brief Constructs a pass at the end of the pipeline.
+     * @tparam T The type of the pass.
+     * @param args The arguments to construct the pass with.
+     * @returns A reference to the added pass.
+     */
+    template<std::derived_from<GraphPass> T, typename... Args>
+    T& AddPass(Args&&... args)
+    {
+        auto pass = std::make_unique<T>(std::forward<Args>(args)...);
+        auto& ref = *pass;
+        AddPass(std::move(pass));
+        return ref;
+    }
+
+    /**
+     * @brief Get the number of passes in the pipeline.
+     * @returns The number of passes.
+     */
+    [[nodiscard]] std::size_t Size() const noexcept { return _passes.size(); }
+
+    /**
+     * @brief Runs every pass over the graph, in the order they were added.
+     * @param graph The graph to optimize.
+     * @returns The report of each pass, in the order they ran.
+     */
+    std::vector<OptimizationReport> Run(Graph& graph) const;
+
+  private:
+    std::vector<std::unique_ptr<GraphPass>> _passes;
+};
+
+FLOW_NAMESPACE_END
@@ -0,0 +1,229 @@
+// Copyright (c) 2024, Cisco Systems, Inc.
+// All rights reserved.
+
+#pragma once
+
+#include "Core.hpp"
+#include "Graph.hpp"
+#include "IndexableName.hpp"
+#include "Node.hpp"
+#include "NodeData.hpp"
+#include "Priority.hpp"
+#include "UUID.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+FLOW_NAMESPACE_BEGIN
+
+class GraphInstance;
+
+/**
+ * @brief Immutable topology of a graph, shared by many lightweight instances.
+ *
+ * @details The nodes of the graph serve as prototypes, whose Compute is run for every instance. Each port of every
+ *          node is assigned a slot, and an instance only holds the data of each slot, so that creating an instance is
+ *          a single allocation. Computes of the same node for different instances are serialized by the node lock,
+ *          while different nodes compute for different instances in parallel.
+ *
+ * @note State that nodes keep outside of their ports is shared by all instances.
+ */
+class GraphTemplate : public std::enable_shared_from_this<GraphTemplate>
+{
+  public:
+    /// Data to set on input ports, as the UUID of the node, the key of the port and the data
+    using RunInputs = std::vector<std::tuple<UUID, IndexableName, SharedNodeData>>;
+
+  private:
+    /**
+     * @brief Constructs a template from a graph.
+     * @param graph The graph to create the template from.
+     */
+    explicit GraphTemplate(std::shared_ptr<Graph> graph);
+
+  public:
+    /**
+     * @brief Creates a template from a graph.
+     *
+     * @details The graph becomes the topology of the template, and MUST NOT be modified or run afterwards. Data
+     *          currently set on the ports of its nodes is used as the initial data of every instance.
+     *
+     * @param graph The graph to create the template from.
+     * @returns The shared template.
+     * @throws std::invalid_argument if the graph is null.
+     */
+    static std::shared_ptr<const GraphTemplate> Create(std::shared_ptr<Graph> graph);
+
+    /**
+     * @brief Creates a new instance, with the initial data of the template in each port.
+     * @returns The new instance.
+     */
+    [[nodiscard]] std::shared_ptr<GraphInstance> Instantiate() const;
+
+    /**
+     * @brief Runs the topology once for each set of inputs, distributing the runs across the thread pool of the Env.
+     *
+     * @details Each run executes on its own instance, created with the initial data of the template. All inputs are set
+     *          before any run is scheduled, and the call blocks until every run finished. The calling thread takes runs
+     *          that did not start yet as well, so that calling this from a worker of the pool cannot deadlock.
+     *
+     * @param inputs The inputs of each run.
+     * @param outputs The UUIDs of the nodes and the keys of the output ports to collect after each run.
+     * @param priority The priority of the tasks of the runs.
+     *
+     * @returns The data of each output port, in the order of the outputs, for each run in the order of the inputs.
+     * @throws std::invalid_argument if a node is not in the topology.
+     * @throws std::out_of_range if a node has no port with the given key.
+     *
+     * @note An exception thrown by a run is rethrown once every run finished, the first in the order of the inputs.
+     */
+    [[nodiscard]] std::vector<std::vector<SharedNodeData>> RunBatch(
+        const std::vector<RunInputs>& inputs, const std::vector<std::pair<UUID, IndexableName>>& outputs,
+        Priority priority = Priority::Normal) const;
+
+    /**
+     * @brief Get the shared environment the instances are executed on.
+     * @returns The shared environment of the graph.
+     */
+    [[nodiscard]] const std::shared_ptr<Env>& GetEnv() const noexcept { return _graph->GetEnv(); }
+
+    /**
+     * @brief Get the number of nodes in the topology.
+     * @returns The number of nodes.
+     */
+    [[nodiscard]] std::size_t NodeCount() const noexcept { return _steps.size(); }
+
+    /**
+     * @brief Get the number of port slots each instance holds.
+     * @returns The number of slots.
+     */
+    [[nodiscard]] std::size_t SlotCount() const noexcept { return _defaults.size(); }
+
+  private:
+    friend class GraphInstance;
+
+    /**
+     * @brief A node of the topology with the slots of its ports.
+     */
+    struct Step
+    {
+        SharedNode Prototype;
+        std::vector<std::pair<IndexableName, std::size_t>> Inputs;
+        std::vector<std::pair<IndexableName, std::size_t>> Outputs;
+    };
+
+    /**
+     * @brief A connection from an output slot to the input slot of a node.
+     */
+    struct Edge
+    {
+        std::size_t Node;
+        std::size_t Slot;
+        std::string_view Type;
+    };
+
+    /**
+     * @brief Finds the slot of a port.
+     *
+     * @param id The UUID of the node.
+     * @param key The key of the port.
+     * @param input Flag if the port is an input port, otherwise an output port.
+     *
+     * @returns The index of the step of the node, and the index of the slot of the port.
+     * @throws std::invalid_argument if the node is not in the topology.
+     * @throws std::out_of_range if the node has no such port.
+     */
+    [[nodiscard]] std::pair<std::size_t, std::size_t> FindSlot(const UUID& id, const IndexableName& key,
+                                                               bool input) const;
+
+  private:
+    std::shared_ptr<Graph> _graph;
+
+    /// Nodes in topological order
+    std::vector<Step> _steps;
+
+    /// Index of the step of each node
+    std::unordered_map<UUID, std::size_t> _node_steps;
+
+    /// Connections out of each slot, empty for input slots
+    std::vector<std::vector<Edge>> _edges;
+
+    /// Initial data of each slot
+    std::vector<SharedNodeData> _defaults;
+};
+
+/**
+ * @brief Lightweight instance of a GraphTemplate, holding only the data of the ports.
+ */
+class GraphInstance : public std::enable_shared_from_this<GraphInstance>
+{
+    /**
+     * @brief Constructs an instance of a template.
+     * @param graph_template The template of the instance.
+     */
+    explicit GraphInstance(std::shared_ptr<const GraphTemplate> graph_template);
+
+    friend class GraphTemplate;
+
+  public:
+    /**
+     * @brief Get the template of the instance.
+     * @returns The shared template.
+     */
+    [[nodiscard]] const std::shared_ptr<const GraphTemplate>& GetTemplate() const noexcept { return _template; }
+
+    /**
+     * @brief Sets data on an input port of a node for this instance, marking the node for the next run.
+     *
+     * @param id The UUID of the node.
+     * @param key The key of the input port.
+     * @param data The data to set.
+     *
+     * @throws std::invalid_argument if the node is not in the topology.
+     * @throws std::out_of_range if the node has no input port with the given key.
+     */
+    void SetInputData(const UUID& id, const IndexableName& key, SharedNodeData data);
+
+    /**
+     * @brief Get the data of an output port of a node for this instance.
+     *
+     * @param id The UUID of the node.
+     * @param key The key of the output port.
+     *
+     * @returns The data of the output port.
+     * @throws std::invalid_argument if the node is not in the topology.
+     * @throws std::out_of_range if the node has no output port with the given key.
+     */
+    [[nodiscard]] SharedNodeData GetOutputData(const UUID& id, const IndexableName& key) const;
+
+    /**
+     * @brief Computes the nodes of the instance whose inputs changed, in topological order on the calling thread.
+     *
+     * @details Every node is computed on the first run. Afterwards, a node is only computed when data was set on it,
+     *          or a node connected to it emitted an update.
+     *
+     * @returns The number of nodes that were computed.
+     */
+    std::size_t Run();
+
+    /**
+     * @brief Adds a task running the instance to the thread pool of the shared Env.
+     * @param priority The priority of the task.
+     */
+    void Schedule(Priority priority = Priority::Normal);
+
+  private:
+    std::shared_ptr<const GraphTemplate> _template;
+
+    mutable std::mutex _mutex;
+    std::vector<SharedNodeData> _slots;
+    std::vector<bool> _dirty;
+};
+
+FLOW_NAMESPACE_END
@@ -0,0 +1,211 @@
+// Copyright (c) 2024, Cisco Systems, Inc.
+// All rights reserved.
+
+#pragma once
+
+#include "Core.hpp"
+#include "Env.hpp"
+#include "MPSCQueue.hpp"
+#include "Node.hpp"
+#include "NodeData.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+FLOW_NAMESPACE_BEGIN
+
+/**
+ * @brief Source node for feeding events into a graph from external threads.
+ *
+ * @details Producers call Push from any thread, which only appends the event to a lock-free queue. The queue is
+ *          drained by tasks on the thread pool of the Env, which emit the drained events together as a std::vector<T>
+ *          on the "batch" output. A drain is scheduled as soon as a full batch is queued, and otherwise once the
+ *          latency bound has passed since the oldest undrained event, so that events are never held back for long
+ *          when the rate is low.
+ *
+ * @tparam T The type of the events.
+ */
+template<typename T>
+class IngressNode : public Node
+{
+  public:
+    /**
+     * @brief Constructs an ingress node.
+     *
+     * @param uuid The UUID for the node.
+     * @param name The friendly name of the node.
+     * @param env The shared environment.
+     */
+    explicit IngressNode(const UUID& uuid, const std::string& name, std::shared_ptr<Env> env)
+        : Node(uuid, TypeName_v<IngressNode<T>>, name, std::move(env)), _state{std::make_shared<State>()}
+    {
+        _state->Node = this;
+        AddOutput<std::vector<T>>("batch", "Batch");
+    }
+
+    ~IngressNode() override
+    {
+        std::lock_guard lock(_state->Mutex);
+        _state->Node = nullptr;
+    }
+
+    /**
+     * @brief Queues an event for the graph. Lock-free, and safe to call from any thread.
+     * @param value The event to queue.
+     */
+    void Push(T value)
+    {
+        // Counted before it is queued, so that a drain never takes an event that the size does not include yet.
+        const auto size = _size.fetch_add(1, std::memory_order_acq_rel) + 1;
+        _queue.Push(std::move(value));
+
+        if (size >= _batch_size.load(std::memory_order_relaxed))
+        {
+            ScheduleDrain();
+        }
+        else
+        {
+            ArmLatencyTimer();
+        }
+    }
+
+    /**
+     * @brief Get the number of queued events that were not yet drained.
+     * @returns The number of queued events.
+     */
+    [[nodiscard]] std::size_t Size() const noexcept { return _size.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Get the maximum number of events emitted in one batch.
+     * @returns The batch size.
+     */
+    [[nodiscard]] std::size_t GetBatchSize() const noexcept { return _batch_size.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Set the maximum number of events emitted in one batch.
+     * @param batch_size The new batch size, at least 1.
+     */
+    void SetBatchSize(std::size_t batch_size) noexcept
+    {
+        _batch_size.store(std::max<std::size_t>(batch_size, 1), std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get the longest time an event waits for its batch to fill before being drained.
+     * @returns The latency bound.
+     */
+    [[nodiscard]] std::chrono::microseconds GetLatencyBound() const noexcept
+    {
+        return std::chrono::microseconds(_latency_bound.load(std::memory_order_relaxed));
+    }
+
+    /**
+     * @brief Set the longest time an event waits for its batch to fill before being drained.
+     * @param latency_bound The new latency bound, zero to drain as soon as an event is pushed.
+     */
+    void SetLatencyBound(std::chrono::microseconds latency_bound) noexcept
+    {
+        _latency_bound.store(latency_bound.count(), std::memory_order_relaxed);
+    }
+
+  protected:
+    void Compute() override {}
+
+  private:
+    /// Shared with pending tasks and timers, so that they can outlive the node. Its mutex also keeps drains, the only
+    /// consumers of the queue, from overlapping.
+    struct State
+    {
+        std::mutex Mutex;
+        IngressNode* Node = nullptr;
+    };
+
+    template<typename F>
+    static auto WithNode(const std::shared_ptr<State>& state, F&& func)
+    {
+        return [state, func = std::forward<F>(func)] {
+            std::lock_guard lock(state->Mutex);
+            if (state->Node != nullptr)
+            {
+                func(*state->Node);
+            }
+        };
+    }
+
+    void ScheduleDrain()
+    {
+        if (!_drain_scheduled.exchange(true, std::memory_order_acq_rel))
+        {
+            GetEnv()->AddTask(WithNode(_state, [](IngressNode& node) { node.Drain(); }));
+        }
+    }
+
+    void ArmLatencyTimer()
+    {
+        const auto latency_bound = GetLatencyBound();
+        if (latency_bound.count() <= 0)
+        {
+            ScheduleDrain();
+        }
+        else if (!_timer_armed.exchange(true, std::memory_order_acq_rel))
+        {
+            GetEnv()->AddTimer(latency_bound, WithNode(_state, [](IngressNode& node) {
+                                   node._timer_armed.store(false, std::memory_order_release);
+                                   node.ScheduleDrain();
+                               }));
+        }
+    }
+
+    void Drain()
+    {
+        _drain_scheduled.store(false, std::memory_order_release);
+
+        const auto batch_size = GetBatchSize();
+
+        std::vector<T> batch;
+        batch.reserve(std::min(batch_size, Size()));
+
+        std::optional<T> value;
+        while (batch.size() < batch_size && _queue.TryPop(value))
+        {
+            batch.push_back(std::move(*value));
+        }
+
+        const auto remaining = _size.fetch_sub(batch.size(), std::memory_order_acq_rel) - batch.size();
+
+        if (!batch.empty())
+        {
+            std::lock_guard lock(*this);
+            SetOutputData("batch", MakeNodeData(std::move(batch)));
+        }
+
+        if (remaining >= batch_size)
+        {
+            ScheduleDrain();
+        }
+        else if (remaining > 0)
+        {
+            ArmLatencyTimer();
+        }
+    }
+
+  private:
+    MPSCQueue<T> _queue;
+    std::atomic<std::size_t> _size = 0;
+
+    std::atomic<std::size_t> _batch_size = 256;
+    std::atomic<std::chrono::microseconds::rep> _latency_bound = 1000;
+
+    std::atomic<bool> _drain_scheduled = false;
+    std::atomic<bool> _timer_armed     = false;
+
+    std::shared_ptr<State> _state;
+};
+
+FLOW_NAMESPACE_END
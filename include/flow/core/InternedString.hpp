@@ -0,0 +1,56 @@
+// Copyright (c) 2024, Cisco Systems, Inc.
+// All rights reserved.
+
+#pragma once
+
+#include "Core.hpp"
+
+#include <string>
+#include <string_view>
+
+FLOW_NAMESPACE_BEGIN
+
+/**
+ * @brief Handle to a string stored once in a process wide pool.
+ *
+ * @details Class names, port keys, captions and types repeat across every node of the same class. Interning them keeps
+ *          a single copy of each distinct string, and reduces every use to a pointer. Handles compare equal exactly
+ *          when their strings are equal.
+ *
+ * @note Interned strings are never freed, so only bounded sets of strings SHOULD be interned.
+ */
+class InternedString
+{
+  public:
+    /**
+     * @brief Constructs a handle to the empty string.
+     */
+    InternedString() noexcept;
+
+    /**
+     * @brief Constructs a handle to the pooled copy of a string, adding it to the pool if needed.
+     * @param str The string to intern.
+     */
+    InternedString(std::string_view str);
+
+    InternedString(const std::string& str) : InternedString(std::string_view{str}) {}
+
+    InternedString(const char* str) : InternedString(std::string_view{str}) {}
+
+    /**
+     * @brief Get the interned string.
+     * @returns A reference to the pooled string, valid for the lifetime of the program.
+     */
+    [[nodiscard]] const std::string& Get() const noexcept { return *_str; }
+
+    operator const std::string&() const noexcept { return *_str; }
+
+    operator std::string_view() const noexcept { return *_str; }
+
+    bool operator==(const InternedString& other) const noexcept { return _str == other._str; }
+
+  private:
+    const std::string* _str;
+};
+
+FLOW_NAMESPACE_END
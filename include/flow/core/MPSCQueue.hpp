@@ -0,0 +1,113 @@
+// Copyright (c) 2024, Cisco Systems, Inc.
+// All rights reserved.
+
+#pragma once
+
+#include "Core.hpp"
+
+#include <atomic>
+#include <optional>
+#include <utility>
+
+FLOW_NAMESPACE_BEGIN
+
+/**
+ * @brief Unbounded lock-free queue with many producers and a single consumer.
+ *
+ * @details A linked list queue after Dmitry Vyukov's design. Pushing costs one allocation and one atomic exchange, and
+ *          never blocks or retries. Popping is wait-free, but only one thread may pop at a time.
+ *
+ * @note A push that is in progress can briefly hide the elements pushed after it from the consumer, so TryPop can
+ *       return false while the queue is not empty.
+ *
+ * @tparam T The type of the queued elements.
+ */
+template<typename T>
+class MPSCQueue
+{
+    struct Cell
+    {
+        std::atomic<Cell*> Next = nullptr;
+        std::optional<T> Value;
+    };
+
+  public:
+    MPSCQueue() : _head{new Cell}, _tail{_head.load(std::memory_order_relaxed)} {}
+
+    ~MPSCQueue()
+    {
+        while (_tail != nullptr)
+        {
+            delete std::exchange(_tail, _tail->Next.load(std::memory_order_relaxed));
+        }
+    }
+
+    MPSCQueue(const MPSCQueue&)            = delete;
+    MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+    /**
+     * @brief Pushes an element to the back of the queue. Safe to call from any number of threads.
+     * @param value The element to push.
+     */
+    void Push(T value)
+    {
+        auto cell = new Cell;
+        cell->Value.emplace(std::move(value));
+
+        _head.exchange(cell, std::memory_order_acq_rel)->Next.store(cell, std::memory_order_release);
+    }
+
+    /**
+     * @brief Pops the element at the front of the queue. MUST only be called by one thread at a time.
+     *
+     * @param value Set to the popped element.
+     * @returns true if an element was popped, false otherwise.
+     */
+    bool TryPop(T& value)
+    {
+        auto next = _tail->Next.load(std::memory_order_acquire);
+        if (next == nullptr)
+        {
+            return false;
+        }
+
+        value = std::move(*next->Value);
+        next->Value.reset();
+
+        delete std::exchange(_tail, next);
+        return true;
+    }
+
+    /**
+     * @brief Pops the element at the front of the queue into an optional, so that T needs no default constructor.
+     *        MUST only be called by one thread at a time.
+     *
+     * @param value Set to the popped element.
+     * @returns true if an element was popped, false otherwise.
+     */
+    bool TryPop(std::optional<T>& value)
+    {
+        auto next = _tail->Next.load(std::memory_order_acquire);
+        if (next == nullptr)
+        {
+            return false;
+        }
+
+        value.emplace(std::move(*next->Value));
+        next->Value.reset();
+
+        delete std::exchange(_tail, next);
+        return true;
+    }
+
+  private:
+    static constexpr std::size_t cache_line_size = 64;
+
+    /// Last pushed cell, shared by the producers
+    alignas(cache_line_size) std::atomic<Cell*> _head;
+
+    /// Cell before the front of the queue, only touched by the consumer
+    alignas(cache_line_size) Cell* _tail;
+};
+
+FLOW_NAMESPACE_END
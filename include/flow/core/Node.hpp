@@ -3,17 +3,27 @@
 
 #pragma once
 
+#include "AtomicSharedPtr.hpp"
 #include "Concepts.hpp"
 #include "Core.hpp"
 #include "Event.hpp"
 #include "IndexableName.hpp"
+#include "InternedString.hpp"
 #include "NodeData.hpp"
 #include "Port.hpp"
+#include "Priority.hpp"
+#include "RunContext.hpp"
 #include "UUID.hpp"
 
 #include <nlohmann/json_fwd.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
 #include <mutex>
+#include <optional>
+#include <stop_token>
 #include <string>
 #include <string_view>
 #include <type_traits>
@@ -28,6 +38,40 @@ class Env;
  */
 using SharedNode = std::shared_ptr<class Node>;
 
+/**
+ * @brief Defines how a node handles data arriving on its input ports through connections.
+ */
+enum class InputMode : std::uint8_t
+{
+    /// Every value that arrives is set on the input port and computed, in order of arrival.
+    Queued,
+
+    /// Values that arrive while a compute is pending replace each other, so that at most one compute is queued, and
+    /// it sees the latest data of every input port.
+    Conflating,
+
+    /// Values produced by graph runs are buffered by run sequence number, and the node only computes once all of its
+    /// connected inputs have arrived for a sequence, in increasing sequence order. An input that received a value of a
+    /// later sequence is considered to have skipped the sequence, such as when an upstream node suppressed an
+    /// unchanged value, and keeps its last value. Incomplete sequences older than a computed one are discarded.
+    Ordered,
+};
+
+/**
+ * @brief Defines when a node is computed inline, on the thread of the node that produced its input data.
+ */
+enum class InlinePolicy : std::uint8_t
+{
+    /// The node is computed in its own task, unless the connection it receives data through is fused.
+    Never,
+
+    /// The node is always computed inline, which suits nodes that are known to be cheap.
+    Always,
+
+    /// The node is computed inline when its average compute time is within Settings::InlineThreshold.
+    Auto,
+};
+
 /**
  * @brief The executable node of a graph.
  *
@@ -35,8 +79,6 @@ using SharedNode = std::shared_ptr<class Node>;
  */
 class Node
 {
-    using PortMap = std::unordered_map<IndexableName, SharedPort>;
-
   protected:
     /**
      * @brief Protected constructor for nodes.
@@ -73,7 +115,7 @@ class Node
      * @brief Get the name of the node class
      * @returns A string representing the name of the node class that is being used.
      */
-    [[nodiscard]] const std::string& GetClass() const noexcept { return _class_name; }
+    [[nodiscard]] const std::string& GetClass() const noexcept { return _class_name.Get(); }
 
     /**
      * @brief Set the friendly name of the node.
@@ -81,6 +123,48 @@ class Node
      */
     void SetName(std::string new_name) { _name = std::move(new_name); }
 
+    /**
+     * @brief Get the mode used for handling data arriving through connections.
+     * @returns The input mode of the node.
+     */
+    [[nodiscard]] InputMode GetInputMode() const noexcept { return _input_mode; }
+
+    /**
+     * @brief Set the mode used for handling data arriving through connections.
+     * @param mode The new input mode of the node.
+     */
+    void SetInputMode(InputMode mode) noexcept { _input_mode = mode; }
+
+    /**
+     * @brief Get the priority lane for the tasks of this node.
+     * @returns The priority lane of the node, or nullopt if the node uses the lane of its graph.
+     */
+    [[nodiscard]] std::optional<Priority> GetPriority() const noexcept { return _priority; }
+
+    /**
+     * @brief Set the priority lane for the tasks of this node, overriding the lane of its graph.
+     * @param priority The new priority lane, or nullopt to use the lane of the graph.
+     */
+    void SetPriority(std::optional<Priority> priority) noexcept { _priority = priority; }
+
+    /**
+     * @brief Get the policy for computing the node inline on the thread that produced its input data.
+     * @returns The inline policy of the node.
+     */
+    [[nodiscard]] InlinePolicy GetInlinePolicy() const noexcept { return _inline_policy; }
+
+    /**
+     * @brief Set the policy for computing the node inline on the thread that produced its input data.
+     * @param policy The new inline policy of the node.
+     */
+    void SetInlinePolicy(InlinePolicy policy) noexcept { _inline_policy = policy; }
+
+    /**
+     * @brief Get the moving average of the compute time of the node, which is only measured with InlinePolicy::Auto.
+     * @returns The average compute time, or nullopt if the node was not measured yet.
+     */
+    [[nodiscard]] std::optional<std::chrono::nanoseconds> GetComputeTime() const noexcept;
+
     /**
      * @brief Overridable method that runs after the creation but before execution of a node.
      */
@@ -102,6 +186,46 @@ class Node
      */
     void InvokeCompute() noexcept;
 
+    /**
+     * @brief Checks if input data was set on the node since it was last computed.
+     * @returns true if the node has not computed its current inputs, false otherwise.
+     */
+    [[nodiscard]] bool IsDirty() const noexcept { return _dirty.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Marks the node as needing a compute, regardless of its inputs.
+     *
+     * @details Used by nodes whose outputs depend on state outside of their input ports, so that the next
+     *          Graph::Evaluate computes them again.
+     */
+    void MarkDirty() noexcept { _dirty.store(true, std::memory_order_release); }
+
+    /**
+     * @brief Checks if the outputs of the node only depend on the values of its inputs.
+     *
+     * @details Pure nodes have no side effects, so optimizations are allowed to compute them ahead of time, merge
+     *          identical ones, or remove them when their outputs are not used.
+     *
+     * @returns true if the node is pure, false otherwise.
+     */
+    [[nodiscard]] virtual bool IsPure() const noexcept { return false; }
+
+    /**
+     * @brief Check if the node computes columnar batches of records.
+     *
+     * @details Nodes that support batches have ComputeBatch called instead of Compute whenever one of their inputs
+     *          holds a Column. Other nodes see no data on inputs holding a Column.
+     *
+     * @returns true if the node overrides ComputeBatch, false otherwise.
+     */
+    [[nodiscard]] virtual bool SupportsBatch() const noexcept { return false; }
+
+    /**
+     * @brief Check if any input port holds a Column of records.
+     * @returns true if an input holds a batch, false otherwise.
+     */
+    [[nodiscard]] bool HasBatchInput() const;
+
     /**
      * @brief Get all input ports for this node.
      *
@@ -121,8 +245,9 @@ class Node
      *
      * @param key The unique identifier of the input port.
      *
-     * @returns Reference to the shared data in the port.
+     * @returns Reference to the shared data in the port, read back into memory if it was spilled.
      * @throws std::out_of_range if port not found.
+     * @throws std::runtime_error if spilled data could not be read.
      */
     [[nodiscard]] const SharedNodeData& GetInputData(const IndexableName& key) const;
 
@@ -131,8 +256,9 @@ class Node
      *
      * @param key The unique identifier of the output port.
      *
-     * @returns Reference to the shared data in the port.
+     * @returns Reference to the shared data in the port, read back into memory if it was spilled.
      * @throws std::out_of_range if port not found.
+     * @throws std::runtime_error if spilled data could not be read.
      */
     [[nodiscard]] const SharedNodeData& GetOutputData(const IndexableName& key) const;
 
@@ -144,9 +270,11 @@ class Node
      * @param key The unique identifier of the input port.
      *
      * @returns Typed shared pointer to the data, or nullptr if type mismatch.
+     * @throws std::out_of_range if port not found.
+     * @throws std::runtime_error if spilled data could not be read.
      */
     template<typename T>
-    [[nodiscard]] auto GetInputData(const IndexableName& key) const noexcept
+    [[nodiscard]] auto GetInputData(const IndexableName& key) const
     {
         return CastNodeData<T>(this->GetInputData(key));
     }
@@ -159,9 +287,11 @@ class Node
      * @param key The unique identifier of the output port.
      *
      * @returns Typed shared pointer to the data, or nullptr if type mismatch.
+     * @throws std::out_of_range if port not found.
+     * @throws std::runtime_error if spilled data could not be read.
      */
     template<typename T>
-    [[nodiscard]] auto GetOutputData(const IndexableName& key) const noexcept
+    [[nodiscard]] auto GetOutputData(const IndexableName& key) const
     {
         return CastNodeData<T>(this->GetOutputData(key));
     }
@@ -184,6 +314,30 @@ class Node
      */
     void SetOutputData(const IndexableName& key, SharedNodeData data = nullptr, bool emit = true);
 
+    /**
+     * @brief Checks if unchanged values are kept from propagating out of an output port.
+     *
+     * @param key The unique identifier of the output port.
+     * @returns true if change detection is enabled on the port, false otherwise.
+     * @throws std::out_of_range if port not found.
+     */
+    [[nodiscard]] bool GetChangeDetection(const IndexableName& key) const;
+
+    /**
+     * @brief Enables or disables keeping unchanged values from propagating out of an output port.
+     *
+     * @details When enabled, setting output data that equals the data already in the port does not emit an update,
+     *          which also skips the computes of all nodes downstream. Values are compared with operator== of the port
+     *          type, or with the comparison registered for the type in the NodeFactory.
+     *
+     * @param key The unique identifier of the output port.
+     * @param enabled Flag if change detection should be enabled.
+     *
+     * @throws std::out_of_range if port not found.
+     * @throws std::invalid_argument if the port type has no operator== and no registered comparison.
+     */
+    void SetChangeDetection(const IndexableName& key, bool enabled);
+
     /**
      * @brief Get an input port by its key.
      *
@@ -219,16 +373,50 @@ class Node
     /**
      * @brief Lock the node mutex.
      */
-    void lock() { _mutex.lock(); }
+    void lock();
+
+    /**
+     * @brief Try to lock the node mutex without waiting.
+     * @returns true if the mutex was locked, false if it is held by another thread.
+     * @note MUST NOT be called by a thread already holding the mutex, see IsLockedByCurrentThread.
+     */
+    bool try_lock();
 
     /**
      * @brief Unlock the node mutex.
      */
-    void unlock() { _mutex.unlock(); }
+    void unlock();
+
+    /**
+     * @brief Checks if the calling thread holds the node mutex, such as further up the stack of an inline compute.
+     * @returns true if the mutex is held by the calling thread, false otherwise.
+     */
+    [[nodiscard]] bool IsLockedByCurrentThread() const noexcept;
 
   protected:
     virtual void Compute() = 0;
 
+    /**
+     * @brief Computes a batch of records, when the node supports batches and an input holds a Column.
+     */
+    virtual void ComputeBatch() {}
+
+    /**
+     * @brief Get the stop token of the graph run being computed.
+     *
+     * @details Long running Compute methods can poll the token, or register a std::stop_callback with it, to stop
+     *          early once the run was cancelled.
+     *
+     * @returns The stop token of the current run, or a token that can never be stopped outside of a run.
+     */
+    [[nodiscard]] static std::stop_token GetStopToken() noexcept;
+
+    /**
+     * @brief Checks if the graph run being computed was cancelled, or has passed its deadline.
+     * @returns true if the computation should stop early, false otherwise.
+     */
+    [[nodiscard]] static bool StopRequested() noexcept;
+
     virtual json SaveInputs() const;
     virtual void RestoreInputs(const json&);
 
@@ -249,7 +437,12 @@ class Node
     template<typename T>
     void AddInput(std::string_view key, const std::string& caption, SharedNodeData data = nullptr)
     {
-        return AddInput(key, caption, TypeName_v<T>, std::move(data));
+        AddInput(key, caption, TypeName_v<T>, std::move(data));
+
+        if constexpr (concepts::EqualityComparable<T>)
+        {
+            _input_ports.at(key)->SetEquality(&NodeDataEqual<T>);
+        }
     }
 
     /**
@@ -279,7 +472,12 @@ class Node
     template<typename T>
     void AddOutput(std::string_view key, const std::string& caption, SharedNodeData data = nullptr)
     {
-        return AddOutput(key, caption, TypeName_v<T>, std::move(data));
+        AddOutput(key, caption, TypeName_v<T>, std::move(data));
+
+        if constexpr (concepts::EqualityComparable<T>)
+        {
+            _output_ports.at(key)->SetEquality(&NodeDataEqual<T>);
+        }
     }
 
     /**
@@ -314,13 +512,14 @@ class Node
     Event<const UUID&, const IndexableName&, const SharedNodeData&> _propagate_output_update;
 
     friend class Graph;
+    friend class GraphTemplate;
 
   private:
     /// Unique identifier for this node
     UUID _id;
 
-    /// Type name of the concrete node class
-    std::string _class_name;
+    /// Type name of the concrete node class, shared by all nodes of the class
+    InternedString _class_name;
 
     /// User-friendly display name
     std::string _name;
@@ -328,6 +527,46 @@ class Node
     /// Shared environment reference
     std::shared_ptr<Env> _env;
 
+    /// Mode used for handling data arriving through connections
+    InputMode _input_mode = InputMode::Queued;
+
+    /// Priority lane overriding the lane of the graph
+    std::optional<Priority> _priority;
+
+    /// Policy for computing the node inline on the thread of its producer
+    std::atomic<InlinePolicy> _inline_policy = InlinePolicy::Never;
+
+    /// Flag set when input data was set since the last compute
+    std::atomic<bool> _dirty = true;
+
+    /// Flag set while a compute of pending conflated inputs is queued
+    std::atomic<bool> _compute_scheduled = false;
+
+    /// Exponential moving average of the compute time in nanoseconds, negative until measured
+    std::atomic<std::int64_t> _compute_time = -1;
+
+    /// Remaining path length of the node in its graph, cached for task priorities
+    std::atomic<std::size_t> _path_length = 0;
+
+    /// Run context of the latest data set in the pending slots of the input ports
+    AtomicSharedPtr<const RunContext> _pending_context;
+
+    /// Input data of a single run, buffered until all connected inputs have arrived
+    struct OrderedInputs
+    {
+        SharedRunContext Context;
+        std::unordered_map<IndexableName, SharedNodeData> Data;
+    };
+
+    /// Ordered input data buffered by sequence number
+    std::map<std::uint64_t, OrderedInputs> _ordered_inputs;
+
+    /// Sequence number of the last ordered compute
+    std::uint64_t _last_sequence = 0;
+
+    /// Latest sequence number each ordered input received a value for
+    std::unordered_map<IndexableName, std::uint64_t> _latest_sequences;
+
     /// Collection of input ports mapped by their keys
     PortMap _input_ports;
 
@@ -4,16 +4,22 @@
 #pragma once
 
 #include "Concepts.hpp"
+#include "RunArena.hpp"
 #include "TypeName.hpp"
 
 #include <nlohmann/json_fwd.hpp>
 
 #include <chrono>
+#include <concepts>
+#include <istream>
 #include <map>
 #include <memory>
+#include <ostream>
+#include <ranges>
 #include <span>
 #include <string>
 #include <type_traits>
+#include <utility>
 
 FLOW_NAMESPACE_BEGIN
 
@@ -100,6 +106,104 @@ std::string ToString(const T& value)
     return ::flow::ToString<std::int64_t>(value.count());
 }
 
+/**
+ * @brief Estimates the memory held by a value, including the storage it owns on the heap.
+ * @tparam T The type of the value being measured.
+ *
+ * @param value The value to measure.
+ *
+ * @note This method SHOULD be overloaded for types owning large buffers, so that they are seen by memory accounting.
+ *
+ * @returns The estimated number of bytes.
+ */
+template<typename T>
+std::size_t SizeInBytes(const T&)
+{
+    return sizeof(T);
+}
+
+template<typename T>
+    requires std::ranges::contiguous_range<T> && std::ranges::sized_range<T> && (!std::ranges::view<T>)
+std::size_t SizeInBytes(const T& value)
+{
+    return sizeof(T) + std::ranges::size(value) * sizeof(std::ranges::range_value_t<T>);
+}
+
+template<typename T>
+std::size_t SizeInBytes(const std::unique_ptr<T>& value)
+{
+    return sizeof(value) + (value ? ::flow::SizeInBytes<T>(*value) : 0);
+}
+
+/**
+ * @brief Writes a value to a stream as raw bytes, so that it can be released from memory and read back later.
+ * @tparam T The type of the value being written.
+ *
+ * @param stream The stream to write to.
+ * @param value The value to write.
+ *
+ * @returns true if the value was written, false if values of the type cannot be written as bytes.
+ */
+template<typename T>
+bool WriteBytes(std::ostream&, const T&)
+{
+    return false;
+}
+
+template<typename T>
+    requires std::is_trivially_copyable_v<T> && (!std::is_pointer_v<T>)
+bool WriteBytes(std::ostream& stream, const T& value)
+{
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    return stream.good();
+}
+
+template<concepts::ByteBuffer T>
+bool WriteBytes(std::ostream& stream, const T& value)
+{
+    const std::uint64_t size = std::ranges::size(value);
+    stream.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    stream.write(reinterpret_cast<const char*>(std::ranges::data(value)),
+                 static_cast<std::streamsize>(size * sizeof(std::ranges::range_value_t<T>)));
+    return stream.good();
+}
+
+/**
+ * @brief Reads a value written by WriteBytes from a stream.
+ * @tparam T The type of the value being read.
+ *
+ * @param stream The stream to read from.
+ * @param value The value to read into.
+ *
+ * @returns true if the value was read, false otherwise.
+ */
+template<typename T>
+bool ReadBytes(std::istream&, T&)
+{
+    return false;
+}
+
+template<typename T>
+    requires std::is_trivially_copyable_v<T> && (!std::is_pointer_v<T>)
+bool ReadBytes(std::istream& stream, T& value)
+{
+    return static_cast<bool>(stream.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+template<concepts::ByteBuffer T>
+bool ReadBytes(std::istream& stream, T& value)
+{
+    std::uint64_t size = 0;
+    if (!stream.read(reinterpret_cast<char*>(&size), sizeof(size)))
+    {
+        return false;
+    }
+
+    value.resize(size);
+    return static_cast<bool>(stream.read(reinterpret_cast<char*>(std::ranges::data(value)),
+                                         static_cast<std::streamsize>(size * sizeof(std::ranges::range_value_t<T>))));
+}
+
 template<typename T>
 struct EnumAsByte : std::false_type
 {
@@ -115,6 +219,15 @@ struct TypeName<T> : TypeName<EnumAsByte<T>>
 {
 };
 
+template<typename T>
+class NodeData;
+
+namespace detail
+{
+template<typename T, typename... Args>
+[[nodiscard]] std::shared_ptr<flow::NodeData<T>> AllocateNodeData(Args&&... args);
+} // namespace detail
+
 /**
  * @brief Interface for node data.
  */
@@ -135,6 +248,18 @@ class INodeData
      */
     virtual std::string ToString() const = 0;
 
+    /**
+     * @brief Estimates the memory held by the current data's value.
+     * @returns The estimated number of bytes, including the storage the value owns on the heap.
+     */
+    virtual std::size_t SizeInBytes() const = 0;
+
+    /**
+     * @brief Checks if the data was allocated from the arena of a run, which it keeps alive.
+     * @returns true if the data lives in a RunArena, false if it lives on the heap.
+     */
+    [[nodiscard]] bool IsInArena() const noexcept { return _in_arena; }
+
   protected:
     /**
      * @brief Get the current data as a void pointer.
@@ -147,7 +272,39 @@ class INodeData
      */
     virtual void FromPointer(void* data) = 0;
 
+    /**
+     * @brief Writes the current value to a stream, so that it can be released from memory.
+     * @param stream The stream to write to.
+     * @returns true if the value was written, false if the type cannot be written as bytes.
+     */
+    virtual bool WriteBytes(std::ostream& stream) const = 0;
+
+    /**
+     * @brief Sets the current value from a stream written by WriteBytes.
+     * @param stream The stream to read from.
+     * @returns true if the value was read, false otherwise.
+     */
+    virtual bool ReadBytes(std::istream& stream) = 0;
+
+    /**
+     * @brief Creates data of the same type, holding a default constructed value.
+     * @returns The new data, or nullptr if the type cannot be default constructed.
+     */
+    virtual std::shared_ptr<INodeData> MakeEmpty() const = 0;
+
+    /**
+     * @brief Creates a copy of the data on the heap.
+     * @returns The copy, or nullptr if the value cannot be copied.
+     */
+    virtual std::shared_ptr<INodeData> Clone() const = 0;
+
     friend class Port;
+
+    template<typename T, typename... Args>
+    friend std::shared_ptr<NodeData<T>> detail::AllocateNodeData(Args&&... args);
+
+  private:
+    bool _in_arena = false;
 };
 
 /**
@@ -155,6 +312,9 @@ class INodeData
  */
 using SharedNodeData = std::shared_ptr<class INodeData>;
 
+template<typename T>
+class NodeData;
+
 namespace detail
 {
 template<typename T>
@@ -269,6 +429,11 @@ class NodeData : public INodeData
 
     virtual std::string ToString() const override { return ::flow::ToString(this->_value); }
 
+    virtual std::size_t SizeInBytes() const override
+    {
+        return sizeof(*this) - sizeof(_value) + ::flow::SizeInBytes(this->_value);
+    }
+
   protected:
     void* AsPointer() const override
     {
@@ -289,6 +454,45 @@ class NodeData : public INodeData
         }
     }
 
+    bool WriteBytes(std::ostream& stream) const override { return ::flow::WriteBytes(stream, this->_value); }
+
+    bool ReadBytes(std::istream& stream) override
+    {
+        if constexpr (std::is_reference_v<value_type> || std::is_const_v<std::remove_reference_t<T>>)
+        {
+            return false;
+        }
+        else
+        {
+            return ::flow::ReadBytes(stream, this->_value);
+        }
+    }
+
+    std::shared_ptr<INodeData> MakeEmpty() const override
+    {
+        if constexpr (std::is_reference_v<value_type> || !std::is_default_constructible_v<flow::NodeData<T>>)
+        {
+            return nullptr;
+        }
+        else
+        {
+            return std::make_shared<flow::NodeData<T>>();
+        }
+    }
+
+    std::shared_ptr<INodeData> Clone() const override
+    {
+        if constexpr (std::is_reference_v<value_type> || !std::is_copy_constructible_v<value_type> ||
+                      !std::is_constructible_v<flow::NodeData<T>, const value_type&>)
+        {
+            return nullptr;
+        }
+        else
+        {
+            return std::make_shared<flow::NodeData<T>>(std::as_const(this->_value));
+        }
+    }
+
   protected:
     value_type _value;
 };
@@ -400,6 +604,27 @@ using TSharedNodeData = std::shared_ptr<class NodeData<T>>;
 template<typename T>
 using TWeakNodeData = std::weak_ptr<class NodeData<T>>;
 
+namespace detail
+{
+/**
+ * @brief Allocates node data from the arena of the current run, or on the heap outside of runs using an arena.
+ */
+template<typename T, typename... Args>
+[[nodiscard]] std::shared_ptr<flow::NodeData<T>> AllocateNodeData(Args&&... args)
+{
+    using Data = flow::NodeData<T>;
+    if (auto* arena = RunArena::Current())
+    {
+        auto data = std::allocate_shared<Data>(RunArenaAllocator<Data>{arena->shared_from_this()},
+                                               std::forward<Args>(args)...);
+        data->_in_arena = true;
+        return data;
+    }
+
+    return std::make_shared<Data>(std::forward<Args>(args)...);
+}
+} // namespace detail
+
 /**
  * @brief Helper function for TSharedNodeData.
  * @tparam T The data type being created.
@@ -409,25 +634,25 @@ using TWeakNodeData = std::weak_ptr<class NodeData<T>>;
 template<typename T>
 [[nodiscard]] constexpr auto MakeNodeData(const T& value)
 {
-    return std::make_shared<NodeData<T>>(value);
+    return detail::AllocateNodeData<T>(value);
 }
 
 template<typename T>
 [[nodiscard]] constexpr auto MakeNodeData(T&& value)
 {
-    return std::make_shared<NodeData<T>>(std::move(value));
+    return detail::AllocateNodeData<T>(std::move(value));
 }
 
 template<typename T, typename U>
 [[nodiscard]] constexpr auto MakeNodeData(const NodeData<U>& value)
 {
-    return std::make_shared<NodeData<T>>(value);
+    return detail::AllocateNodeData<T>(value);
 }
 
 template<typename T, typename U>
 [[nodiscard]] constexpr auto MakeNodeData(NodeData<U>&& value)
 {
-    return std::make_shared<NodeData<T>>(std::move(value));
+    return detail::AllocateNodeData<T>(std::move(value));
 }
 
 template<concepts::Reference T>
@@ -442,4 +667,22 @@ template<typename T>
     return std::dynamic_pointer_cast<NodeData<T>>(value);
 }
 
+/**
+ * @brief Compares the values of two node data with operator==.
+ *
+ * @tparam T The data type of both node data.
+ * @param lhs The first data to compare.
+ * @param rhs The second data to compare.
+ *
+ * @returns true if both hold a T and the values are equal, false otherwise.
+ */
+template<typename T>
+    requires concepts::EqualityComparable<T>
+[[nodiscard]] bool NodeDataEqual(const SharedNodeData& lhs, const SharedNodeData& rhs)
+{
+    auto lhs_data = CastNodeData<T>(lhs);
+    auto rhs_data = CastNodeData<T>(rhs);
+    return lhs_data && rhs_data && std::as_const(*lhs_data).Get() == std::as_const(*rhs_data).Get();
+}
+
 FLOW_NAMESPACE_END
@@ -118,6 +118,46 @@ class NodeFactory
     template<typename From, typename To, typename... Ts>
     void RegisterCompleteConversion();
 
+    /**
+     * @brief Registers how to compare values of a type, for change detection on output ports of that type.
+     *
+     * @tparam T The type to compare.
+     * @param equality The comparison function, defaults to comparing with operator==.
+     */
+    template<typename T>
+    void RegisterEquality(const TypeRegistry::EqualityFunc& equality = NodeDataEqual<T>)
+    {
+        _conversion_registry.RegisterEquality<T>(equality);
+    }
+
+    /**
+     * @brief Gets the registered comparison of a type.
+     *
+     * @param type The name of the type.
+     * @returns The comparison function, or an empty function if none is registered.
+     */
+    TypeRegistry::EqualityFunc GetEquality(std::string_view type) const;
+
+    /**
+     * @brief Registers how to hash values of a type, for keying the result caches of function nodes.
+     *
+     * @tparam T The type to hash.
+     * @param hash The hash function, defaults to std::hash.
+     */
+    template<typename T>
+    void RegisterHash(std::function<std::size_t(const T&)> hash = std::hash<T>{})
+    {
+        _conversion_registry.RegisterHash<T>(std::move(hash));
+    }
+
+    /**
+     * @brief Gets the registered hash of a type.
+     *
+     * @param type The name of the type.
+     * @returns The hash function, or nullptr if none is registered.
+     */
+    const TypeRegistry::HashFunc* GetHash(std::string_view type) const;
+
     /**
      * @brief Converts the given data to the specified typename.
      *
@@ -0,0 +1,145 @@
+// Copyright (c) 2024, Cisco Systems, Inc.
+// All rights reserved.
+
+#pragma once
+
+#include "AtomicSharedPtr.hpp"
+#include "Core.hpp"
+#include "Event.hpp"
+#include "IndexableName.hpp"
+#include "Node.hpp"
+#include "NodeData.hpp"
+#include "UUID.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+FLOW_NAMESPACE_BEGIN
+
+/**
+ * @brief Latest data of an observed output port.
+ */
+struct ObservedUpdate
+{
+    /// The UUID of the node
+    UUID NodeID;
+
+    /// The key of the output port
+    IndexableName PortKey;
+
+    /// The latest data set on the port
+    SharedNodeData Data;
+};
+
+/**
+ * @brief Delivers coalesced updates of observed output ports to subscribers, on a thread of its own.
+ *
+ * @details Observing a port binds a hook to Node::OnSetOutput, which only stores the data in a slot of the port and
+ *          marks it changed, so the worker computing the node never waits on a subscriber. At most once per interval,
+ *          the delivery thread collects the ports that changed since the last delivery, and broadcasts their latest
+ *          data through OnUpdates. Values set in between deliveries are dropped, so that slow subscribers such as
+ *          editors and monitors see the most recent state at a bounded rate.
+ *
+ * @note The data is shared with the node and not copied, so subscribers MUST NOT modify it.
+ */
+class ObserverChannel
+{
+  public:
+    /**
+     * @brief Constructs a channel, and starts its delivery thread.
+     * @param interval The minimum time between deliveries.
+     */
+    explicit ObserverChannel(std::chrono::milliseconds interval = std::chrono::milliseconds{33});
+
+    ~ObserverChannel();
+
+    ObserverChannel(const ObserverChannel&)            = delete;
+    ObserverChannel& operator=(const ObserverChannel&) = delete;
+
+    /**
+     * @brief Observes an output port of a node.
+     *
+     * @param node The node to observe.
+     * @param key The key of the output port.
+     *
+     * @throws std::out_of_range if the node has no output port with the given key.
+     */
+    void Observe(const SharedNode& node, const IndexableName& key);
+
+    /**
+     * @brief Stops observing an output port of a node.
+     *
+     * @param id The UUID of the node.
+     * @param key The key of the output port.
+     *
+     * @returns true if the port was observed, false otherwise.
+     */
+    bool Unobserve(const UUID& id, const IndexableName& key);
+
+    /**
+     * @brief Get the minimum time between deliveries.
+     * @returns The delivery interval.
+     */
+    [[nodiscard]] std::chrono::milliseconds GetInterval() const;
+
+    /**
+     * @brief Set the minimum time between deliveries.
+     * @param interval The new delivery interval.
+     */
+    void SetInterval(std::chrono::milliseconds interval);
+
+    /**
+     * @brief Delivers the pending updates on the calling thread, without waiting for the interval.
+     * @returns The number of updates delivered.
+     */
+    std::size_t Flush();
+
+  public:
+    /// Event triggered on the delivery thread with the latest data of each port that changed
+    EventDispatcher<const std::vector<ObservedUpdate>&> OnUpdates;
+
+  private:
+    /// Latest data of a port, written by the hook on the node and read by the delivery thread
+    struct Slot
+    {
+        AtomicSharedPtr<INodeData> Data;
+        std::atomic<bool> Changed = false;
+    };
+
+    struct Observation
+    {
+        std::weak_ptr<Node> Owner;
+        UUID NodeID;
+        IndexableName PortKey;
+
+        /// Name of the hook on the node, whose key views this string, so that its address has to stay fixed
+        std::unique_ptr<const std::string> HookName;
+        std::shared_ptr<Slot> Latest;
+    };
+
+    void Unbind(const Observation& observation);
+
+    void Service(std::stop_token token);
+
+  private:
+    /// Unique identifier of the channel, used to name its hooks
+    UUID _id;
+
+    mutable std::mutex _mutex;
+    std::condition_variable_any _cv;
+    std::chrono::milliseconds _interval;
+    std::vector<Observation> _observations;
+
+    /// Keeps deliveries in order when flushing from another thread
+    std::mutex _delivery_mutex;
+
+    std::jthread _thread;
+};
+
+FLOW_NAMESPACE_END
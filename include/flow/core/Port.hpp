@@ -3,20 +3,49 @@
 
 #pragma once
 
+#include "AtomicSharedPtr.hpp"
 #include "Core.hpp"
 #include "Event.hpp"
 #include "IndexableName.hpp"
+#include "InternedString.hpp"
 #include "NodeData.hpp"
 
 #include <nlohmann/json_fwd.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
 #include <stdint.h>
+#include <string>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 FLOW_NAMESPACE_BEGIN
 
 using json = nlohmann::json;
 
+/**
+ * @brief Defines how long a port retains the data set on it.
+ */
+enum class RetentionPolicy : std::uint8_t
+{
+    /// The data is kept until it is replaced.
+    KeepLast,
+
+    /// The data is released once it was consumed, by a compute of the node for input ports, or by the connections for
+    /// output ports. Required ports keep their data.
+    ReleaseAfterConsume,
+
+    /// The data is written to a file once it was consumed, and read back when it is accessed through the node. Data
+    /// of types that cannot be written as bytes is kept in memory.
+    Spill,
+};
+
 /**
  * @brief Defines a Port on a Node through which data can flow.
  *
@@ -25,6 +54,9 @@ using json = nlohmann::json;
 class Port
 {
   public:
+    /// Function type for comparing the values of two node data
+    using EqualityFunc = std::function<bool(const SharedNodeData& lhs, const SharedNodeData& rhs)>;
+
     /**
      * @brief Constructs a port with clarifying information and default data.
      * @param key The unique IndexableName of the Port.
@@ -37,10 +69,12 @@ class Port
     Port(const IndexableName& key, const std::string& caption, std::string_view type, SharedNodeData data,
          bool required, std::size_t index);
 
-    Port(const Port&)            = default;
-    Port(Port&&)                 = default;
-    Port& operator=(const Port&) = default;
-    Port& operator=(Port&&)      = default;
+    Port(const Port&)            = delete;
+    Port(Port&&)                 = delete;
+    Port& operator=(const Port&) = delete;
+    Port& operator=(Port&&)      = delete;
+
+    ~Port();
 
     /**
      * @brief Checks if the port has a connection.
@@ -61,10 +95,19 @@ class Port
     bool Disconnect() noexcept;
 
     /**
-     * @brief Get the data currently being stored.
-     * @returns The currently stored data pointer.
+     * @brief Get the data currently being stored, reading spilled data back into memory first.
+     * @returns The currently stored data pointer, which is null once released after being consumed.
+     * @throws std::runtime_error if the spilled data could not be read.
      */
-    const SharedNodeData& GetData() const noexcept { return _data; }
+    const SharedNodeData& GetData() const
+    {
+        if (IsSpilled())
+        {
+            Restore();
+        }
+
+        return _data;
+    }
 
     /**
      * @brief Get the unique hashable name of the Port.
@@ -82,13 +125,22 @@ class Port
      * @brief Get the caption/alternate name of the Port.
      * @returns The friendly description/alternate name of the Port.
      */
-    std::string_view GetCaption() const noexcept { return _caption; }
+    std::string_view GetCaption() const noexcept
+    {
+        return _custom_caption ? std::string_view(*_custom_caption) : std::string_view(_caption);
+    }
 
     /**
      * @brief Get the name of the data type currently stored.
      * @returns The current data typename, else returns the default typename.
      */
-    std::string_view GetDataType() const noexcept { return _data ? _data->Type() : _type; }
+    std::string_view GetDataType() const noexcept { return _data ? _data->Type() : std::string_view{_type}; }
+
+    /**
+     * @brief Get the name of the data type the port was declared with.
+     * @returns The declared typename of the port, regardless of the data currently stored.
+     */
+    std::string_view GetType() const noexcept { return _type; }
 
     /**
      * @brief Check for if the port requires valid data.
@@ -109,8 +161,127 @@ class Port
      */
     void SetData(SharedNodeData data, bool output = false);
 
+    /**
+     * @brief Store data in the pending slot of the port, replacing any data that has not been taken yet.
+     *
+     * @details Used by conflating nodes, where only the latest data to arrive matters. Safe to call concurrently with
+     *          TakePendingData without holding the node lock.
+     *
+     * @param data The new pending data.
+     */
+    void SetPendingData(SharedNodeData data) noexcept;
+
+    /**
+     * @brief Take the data from the pending slot of the port.
+     * @param data The pending data, if any was set.
+     * @returns true if pending data was taken, false otherwise.
+     */
+    bool TakePendingData(SharedNodeData& data) noexcept;
+
+    /**
+     * @brief Checks if unchanged values are kept from propagating out of the port.
+     * @returns true if change detection is enabled, false otherwise.
+     */
+    bool GetChangeDetection() const noexcept { return _change_detection; }
+
+    /**
+     * @brief Enables or disables keeping unchanged values from propagating out of the port.
+     * @param enabled Flag if change detection should be enabled. Has no effect without an equality function.
+     */
+    void SetChangeDetection(bool enabled) noexcept { _change_detection = enabled; }
+
+    /**
+     * @brief Get the function used to compare values for change detection.
+     * @returns The comparison function, which may be empty.
+     */
+    const EqualityFunc& GetEquality() const noexcept { return _equality; }
+
+    /**
+     * @brief Set the function used to compare values for change detection.
+     * @param equality The new comparison function.
+     */
+    void SetEquality(EqualityFunc equality) { _equality = std::move(equality); }
+
+    /**
+     * @brief Checks if new data is equal to the data currently stored, when change detection is enabled.
+     *
+     * @details Data referring to the same object as the stored data is never considered unchanged, since the object
+     *          may have been modified in place.
+     *
+     * @param data The new data.
+     * @returns true if change detection is enabled and the values are equal, false otherwise.
+     */
+    bool IsUnchanged(const SharedNodeData& data) const;
+
+    /**
+     * @brief Get the version of the data in the port.
+     *
+     * @details For output ports, the version counts the updates emitted from the port. For input ports, it is the
+     *          version of the connected output port whose data was last pulled into the port by Graph::Evaluate.
+     *
+     * @returns The current version of the port.
+     */
+    std::uint64_t GetVersion() const noexcept { return _version.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Set the version of the data in the port.
+     * @param version The new version.
+     */
+    void SetVersion(std::uint64_t version) noexcept { _version.store(version, std::memory_order_release); }
+
+    /**
+     * @brief Increments the version of the data in the port.
+     */
+    void BumpVersion() noexcept { _version.fetch_add(1, std::memory_order_acq_rel); }
+
+    /**
+     * @brief Get the policy defining how long the port retains its data.
+     * @returns The retention policy of the port.
+     */
+    RetentionPolicy GetRetention() const noexcept { return _retention; }
+
+    /**
+     * @brief Set the policy defining how long the port retains its data.
+     * @param retention The new retention policy.
+     */
+    void SetRetention(RetentionPolicy retention) noexcept { _retention = retention; }
+
+    /**
+     * @brief Replaces data allocated in the arena of a run with a copy on the heap.
+     *
+     * @details Called once the run completed, so that the data the port holds on to does not keep all memory of the
+     *          run alive. Values that cannot be copied keep their arena.
+     */
+    void Promote();
+
+    /**
+     * @brief Applies the retention policy to the data, once it was consumed.
+     * @param spill_directory The directory to write spilled data to, or empty for the temporary directory.
+     * @returns true if the data was released from memory, false if it is retained.
+     */
+    bool Release(const std::filesystem::path& spill_directory);
+
+    /**
+     * @brief Checks if the data of the port was written to a file and released from memory.
+     * @returns true if the data is spilled, false otherwise.
+     */
+    bool IsSpilled() const noexcept { return _spilled.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Reads spilled data back into memory.
+     *
+     * @details Safe to call concurrently with other readers of the port, since readers only hold the data pointer,
+     *          whose value is read back in place.
+     *
+     * @throws std::runtime_error if the spilled data could not be read.
+     */
+    void Restore() const;
+
     /**
      * @brief Set a new caption for the port.
+     *
+     * @note The caption is owned by the port rather than interned, since captions set at runtime are unbounded.
+     *
      * @param new_caption The new caption to set.
      */
     void SetCaption(std::string new_caption);
@@ -125,17 +296,112 @@ class Port
 
   private:
     std::shared_ptr<INodeData> _data;
+    AtomicSharedPtr<INodeData> _pending_data;
+    std::atomic<bool> _has_pending_data = false;
+
+    IndexableName _key = IndexableName::None;
+    InternedString _caption;
+    InternedString _type;
 
-    IndexableName _key   = IndexableName::None;
-    std::string _caption = "";
-    std::string _type    = "";
-    bool _required       = false;
-    bool _connected      = false;
-    std::size_t _index   = 0;
+    /// Caption set after construction, which overrides the interned caption
+    std::unique_ptr<std::string> _custom_caption;
+    std::size_t _index = 0;
+
+    bool _required         = false;
+    bool _connected        = false;
+    bool _change_detection = false;
+    EqualityFunc _equality;
+
+    std::atomic<std::uint64_t> _version = 0;
+
+    RetentionPolicy _retention = RetentionPolicy::KeepLast;
+
+    /// File the data was spilled to, null while the data is in memory
+    mutable std::unique_ptr<std::filesystem::path> _spill_file;
+    mutable std::atomic<bool> _spilled = false;
+
+    /// Guards the spill file, so that readers without the node lock restore the data only once
+    mutable std::mutex _spill_mutex;
+
+  private:
+    void DiscardSpill() const noexcept;
 };
 
 using SharedPort = std::shared_ptr<Port>;
 
+/**
+ * @brief Ports of a node keyed by name, stored inline in declaration order.
+ *
+ * @details Nodes have a handful of ports, for which a linear scan over the hashed keys in one contiguous array is
+ *          smaller and faster than the buckets and per-entry allocations of an unordered map.
+ */
+class PortMap
+{
+  public:
+    using value_type     = std::pair<IndexableName, SharedPort>;
+    using iterator       = std::vector<value_type>::iterator;
+    using const_iterator = std::vector<value_type>::const_iterator;
+
+    /**
+     * @brief Adds a port if the key is not in use.
+     * @param key The key of the port.
+     * @param port The port to add.
+     * @returns An iterator to the port with the key, and true if the port was added.
+     */
+    std::pair<iterator, bool> emplace(const IndexableName& key, SharedPort port)
+    {
+        if (auto found = find(key); found != _ports.end())
+        {
+            return {found, false};
+        }
+
+        _ports.emplace_back(key, std::move(port));
+        return {std::prev(_ports.end()), true};
+    }
+
+    /**
+     * @brief Get the port with the given key.
+     * @param key The key of the port.
+     * @returns The port with the key.
+     * @throws std::out_of_range if no port has the key.
+     */
+    const SharedPort& at(const IndexableName& key) const
+    {
+        auto found = find(key);
+        if (found == _ports.end())
+        {
+            throw std::out_of_range("no port named " + std::string{std::string_view(key)});
+        }
+
+        return found->second;
+    }
+
+    iterator find(const IndexableName& key) noexcept
+    {
+        return std::find_if(_ports.begin(), _ports.end(), [&](const auto& entry) { return entry.first == key; });
+    }
+
+    const_iterator find(const IndexableName& key) const noexcept
+    {
+        return std::find_if(_ports.begin(), _ports.end(), [&](const auto& entry) { return entry.first == key; });
+    }
+
+    bool contains(const IndexableName& key) const noexcept { return find(key) != _ports.end(); }
+
+    std::size_t size() const noexcept { return _ports.size(); }
+
+    bool empty() const noexcept { return _ports.empty(); }
+
+    iterator begin() noexcept { return _ports.begin(); }
+    iterator end() noexcept { return _ports.end(); }
+
+    const_iterator begin() const noexcept { return _ports.begin(); }
+    const_iterator end() const noexcept { return _ports.end(); }
+
+  private:
+    std::vector<value_type> _ports;
+};
+
 FLOW_NAMESPACE_END
 
 template<>
@@ -0,0 +1,62 @@
+// Copyright (c) 2024, Cisco Systems, Inc.
+// All rights reserved.
+
+#pragma once
+
+#include "Core.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+FLOW_NAMESPACE_BEGIN
+
+/**
+ * @brief The priority of a task in the thread pool. Higher values are dequeued first.
+ */
+using priority_t = std::int8_t;
+
+/**
+ * @brief Priority lanes for tasks run by the Env.
+ *
+ * @details Each lane spans a range of 64 task priorities starting at its value, so that tasks can be ordered within a
+ *          lane without ever overtaking a task of a higher lane.
+ */
+enum class Priority : priority_t
+{
+    /// Bulk work that only runs when no other work is queued.
+    Background = -128,
+
+    /// The default lane for all tasks.
+    Normal = 0,
+
+    /// Latency critical work that runs before any other queued work.
+    Realtime = 64,
+};
+
+/**
+ * @brief Defines how a graph assigns priorities to the tasks of its nodes.
+ */
+enum class PriorityMode : std::uint8_t
+{
+    /// All tasks run at the base of the lane of their node, or of the graph if the node has none.
+    Fixed,
+
+    /// Within their lane, tasks of nodes with a longer remaining path to a leaf run first, so that the critical path
+    /// of the graph is scheduled ahead of short branches.
+    CriticalPath,
+};
+
+/**
+ * @brief Gets the task priority of a lane, offset within the lane.
+ *
+ * @param lane The priority lane.
+ * @param offset The offset within the lane, clamped to the size of a lane.
+ *
+ * @returns The task priority.
+ */
+[[nodiscard]] constexpr priority_t MakePriority(Priority lane, std::size_t offset = 0) noexcept
+{
+    return static_cast<priority_t>(static_cast<int>(lane) + static_cast<int>(std::min<std::size_t>(offset, 63)));
+}
+
+FLOW_NAMESPACE_END
@@ -0,0 +1,220 @@
+// Copyright (c) 2024, Cisco Systems, Inc.
+// All rights reserved.
+
+#pragma once
+
+#include "Core.hpp"
+
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+
+FLOW_NAMESPACE_BEGIN
+
+/**
+ * @brief Statistics of a result cache.
+ */
+struct CacheStats
+{
+    /// Number of lookups that found a cached result.
+    std::size_t Hits = 0;
+
+    /// Number of lookups that found no cached result.
+    std::size_t Misses = 0;
+
+    /// Number of results evicted to stay within the memory budget.
+    std::size_t Evictions = 0;
+
+    /// Number of results currently cached.
+    std::size_t Entries = 0;
+
+    /// Approximate number of bytes used by the cached results.
+    std::size_t Bytes = 0;
+};
+
+/**
+ * @brief Approximates the memory used by a value, including the elements of contiguous containers.
+ *
+ * @tparam T The type of the value.
+ * @param value The value to measure.
+ *
+ * @returns The approximate size of the value in bytes.
+ */
+template<typename T>
+std::size_t ApproximateSize(const T& value)
+{
+    if constexpr (requires { value.data(); value.size(); })
+    {
+        return sizeof(T) + value.size() * sizeof(*value.data());
+    }
+    else if constexpr (requires { std::tuple_size<T>::value; })
+    {
+        return std::apply([](const auto&... elements) { return (std::size_t{0} + ... + ApproximateSize(elements)); },
+                          value);
+    }
+    else
+    {
+        return sizeof(T);
+    }
+}
+
+/**
+ * @brief Thread-safe least recently used cache with a memory budget.
+ *
+ * @details Entries are found by a precomputed hash of their key, and then confirmed by a caller provided comparison of
+ *          the keys, so that hash collisions never return a wrong result. Inserting evicts the least recently used
+ *          entries until the cache fits in its budget again.
+ *
+ * @tparam Key The type of the keys.
+ * @tparam Value The type of the cached values.
+ */
+template<typename Key, typename Value>
+class ResultCache
+{
+    struct Entry
+    {
+        std::size_t Hash;
+        Key EntryKey;
+        Value EntryValue;
+        std::size_t Bytes;
+    };
+
+    using EntryList = std::list<Entry>;
+
+    /// Approximate bookkeeping cost of an entry, for the list and index nodes.
+    static constexpr std::size_t entry_overhead = sizeof(Entry) + 4 * sizeof(void*);
+
+  public:
+    /**
+     * @brief Get the memory budget of the cache.
+     * @returns The budget in bytes, where zero means that the cache is disabled.
+     */
+    [[nodiscard]] std::size_t GetBudget() const
+    {
+        std::lock_guard lock(_mutex);
+        return _budget;
+    }
+
+    /**
+     * @brief Set the memory budget of the cache, evicting entries that no longer fit.
+     * @param budget The new budget in bytes, or zero to disable the cache and clear it.
+     */
+    void SetBudget(std::size_t budget)
+    {
+        std::lock_guard lock(_mutex);
+        _budget = budget;
+        Evict();
+    }
+
+    /**
+     * @brief Looks up a value, marking it as most recently used when found.
+     *
+     * @tparam Equal Callable comparing a cached key to the key being looked up.
+     * @param hash The hash of the key being looked up.
+     * @param equal The key comparison.
+     *
+     * @returns A copy of the cached value, or nullopt if none was found.
+     */
+    template<typename Equal>
+    std::optional<Value> Find(std::size_t hash, Equal&& equal)
+    {
+        std::lock_guard lock(_mutex);
+
+        auto [first, last] = _index.equal_range(hash);
+        for (auto it = first; it != last; ++it)
+        {
+            if (equal(std::as_const(it->second->EntryKey)))
+            {
+                _entries.splice(_entries.begin(), _entries, it->second);
+                ++_stats.Hits;
+                return it->second->EntryValue;
+            }
+        }
+
+        ++_stats.Misses;
+        return std::nullopt;
+    }
+
+    /**
+     * @brief Inserts a value, unless the cache is disabled or the value alone exceeds the budget.
+     *
+     * @param hash The hash of the key.
+     * @param key The key of the value.
+     * @param value The value to cache.
+     */
+    void Insert(std::size_t hash, Key key, Value value)
+    {
+        const auto bytes = ApproximateSize(key) + ApproximateSize(value) + entry_overhead;
+
+        std::lock_guard lock(_mutex);
+        if (bytes > _budget)
+        {
+            return;
+        }
+
+        _entries.push_front(Entry{hash, std::move(key), std::move(value), bytes});
+        _index.emplace(hash, _entries.begin());
+        _stats.Bytes += bytes;
+        ++_stats.Entries;
+
+        Evict();
+    }
+
+    /**
+     * @brief Removes all entries and resets the statistics.
+     */
+    void Clear()
+    {
+        std::lock_guard lock(_mutex);
+        _entries.clear();
+        _index.clear();
+        _stats = {};
+    }
+
+    /**
+     * @brief Get the statistics of the cache.
+     * @returns A snapshot of the statistics.
+     */
+    [[nodiscard]] CacheStats GetStats() const
+    {
+        std::lock_guard lock(_mutex);
+        return _stats;
+    }
+
+  private:
+    void Evict()
+    {
+        while (_stats.Bytes > _budget && !_entries.empty())
+        {
+            auto last                   = std::prev(_entries.end());
+            auto [first, last_matching] = _index.equal_range(last->Hash);
+            for (auto it = first; it != last_matching; ++it)
+            {
+                if (it->second == last)
+                {
+                    _index.erase(it);
+                    break;
+                }
+            }
+
+            _stats.Bytes -= last->Bytes;
+            --_stats.Entries;
+            ++_stats.Evictions;
+            _entries.erase(last);
+        }
+    }
+
+  private:
+    mutable std::mutex _mutex;
+    std::size_t _budget = 0;
+
+    EntryList _entries;
+    std::unordered_multimap<std::size_t, typename EntryList::iterator> _index;
+    CacheStats _stats;
+};
+
+FLOW_NAMESPACE_END
@@ -0,0 +1,154 @@
+// Copyright (c) 2024, Cisco Systems, Inc.
+// All rights reserved.
+
+#pragma once
+
+#include "Core.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+FLOW_NAMESPACE_BEGIN
+
+/**
+ * @brief Monotonic arena for the node data made during a single graph run.
+ *
+ * @details Each thread bump-allocates from a chunk of its own, so allocating takes no lock and touches no memory shared
+ *          with other threads. A thread keeps a chunk for each of the last few arenas it allocated from, so that a
+ *          worker interleaving tasks of concurrent runs does not abandon a chunk at every switch. Deallocating does
+ *          nothing, and all chunks are released at once when the arena is destroyed. Every allocation keeps the arena
+ *          alive, so once a run completed the ports replace the data of the run they hold on to with a copy on the
+ *          heap, and only data that is otherwise kept past the run holds the memory of its run. Allocations larger than
+ *          a quarter of a chunk are made on the heap.
+ *
+ *          The arena is made current on the threads executing its run by RunContext::Scope, and used by MakeNodeData.
+ */
+class RunArena : public std::enable_shared_from_this<RunArena>
+{
+  public:
+    /**
+     * @brief Constructs an arena.
+     * @param chunk_size The size of the chunks each thread allocates from.
+     */
+    explicit RunArena(std::size_t chunk_size);
+
+    ~RunArena();
+
+    RunArena(const RunArena&)            = delete;
+    RunArena& operator=(const RunArena&) = delete;
+
+    /**
+     * @brief Allocates memory from the chunk of the calling thread.
+     *
+     * @param size The number of bytes to allocate.
+     * @param alignment The alignment of the memory.
+     *
+     * @returns A pointer to the allocated memory.
+     */
+    [[nodiscard]] void* Allocate(std::size_t size, std::size_t alignment);
+
+    /**
+     * @brief Releases memory returned by Allocate.
+     *
+     * @details Only memory allocated on the heap is freed, chunk memory is released with the arena.
+     *
+     * @param ptr The pointer to release.
+     * @param size The number of bytes that were allocated.
+     * @param alignment The alignment the memory was allocated with.
+     */
+    void Deallocate(void* ptr, std::size_t size, std::size_t alignment) noexcept;
+
+    /**
+     * @brief Get the size of the chunks of the arena.
+     * @returns The chunk size in bytes.
+     */
+    [[nodiscard]] std::size_t GetChunkSize() const noexcept { return _chunk_size; }
+
+    /**
+     * @brief Get the number of bytes allocated from the chunks.
+     * @returns The number of bytes handed out, including alignment padding.
+     */
+    [[nodiscard]] std::size_t BytesAllocated() const noexcept { return _allocated.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Get the number of chunks taken by all threads.
+     * @returns The number of chunks.
+     */
+    [[nodiscard]] std::size_t ChunkCount() const;
+
+    /**
+     * @brief Get the arena of the run executing on the calling thread.
+     * @returns The current arena, nullptr if data SHOULD be allocated on the heap.
+     */
+    [[nodiscard]] static RunArena* Current() noexcept;
+
+    /**
+     * @brief Makes an arena current on the calling thread for the lifetime of the scope.
+     */
+    class Scope
+    {
+      public:
+        explicit Scope(RunArena* arena) noexcept;
+        ~Scope();
+
+        Scope(const Scope&)            = delete;
+        Scope& operator=(const Scope&) = delete;
+
+      private:
+        RunArena* _previous;
+    };
+
+  private:
+    /// Unique identifier, so that the chunk cached by a thread is never mistaken for one of a later arena.
+    const std::uint64_t _id;
+
+    const std::size_t _chunk_size;
+
+    std::atomic<std::size_t> _allocated = 0;
+
+    mutable std::mutex _mutex;
+    std::vector<std::unique_ptr<std::byte[]>> _chunks;
+};
+
+/**
+ * @brief Allocator of a RunArena, which keeps the arena alive for as long as memory allocated from it is in use.
+ * @tparam T The type of the allocated values.
+ */
+template<typename T>
+class RunArenaAllocator
+{
+  public:
+    using value_type = T;
+
+    explicit RunArenaAllocator(std::shared_ptr<RunArena> arena) noexcept : _arena{std::move(arena)} {}
+
+    template<typename U>
+    RunArenaAllocator(const RunArenaAllocator<U>& other) noexcept : _arena{other.GetArena()}
+    {
+    }
+
+    [[nodiscard]] T* allocate(std::size_t n)
+    {
+        return static_cast<T*>(_arena->Allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* ptr, std::size_t n) noexcept { _arena->Deallocate(ptr, n * sizeof(T), alignof(T)); }
+
+    [[nodiscard]] const std::shared_ptr<RunArena>& GetArena() const noexcept { return _arena; }
+
+    template<typename U>
+    bool operator==(const RunArenaAllocator<U>& other) const noexcept
+    {
+        return _arena == other.GetArena();
+    }
+
+  private:
+    std::shared_ptr<RunArena> _arena;
+};
+
+FLOW_NAMESPACE_END
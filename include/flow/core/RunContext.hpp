@@ -0,0 +1,112 @@
+// Copyright (c) 2024, Cisco Systems, Inc.
+// All rights reserved.
+
+#pragma once
+
+#include "Core.hpp"
+#include "RunArena.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <stop_token>
+
+FLOW_NAMESPACE_BEGIN
+
+/**
+ * @brief Type alias for a shared pointer to a RunContext.
+ */
+using SharedRunContext = std::shared_ptr<const class RunContext>;
+
+/**
+ * @brief State shared by all the tasks of a single graph run.
+ *
+ * @details A run context is carried with all data propagated by a run, and is made current on the thread executing
+ *          any of its tasks, so that nodes can find out which run they are computing for and whether it was cancelled.
+ */
+class RunContext
+{
+  public:
+    using clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Constructs a run context.
+     * @param sequence The sequence number of the run.
+     * @param token The token used to request cancellation of the run.
+     * @param deadline The point in time after which the run is considered cancelled, if any.
+     * @param arena The arena node data of the run is allocated from, nullptr to allocate on the heap.
+     * @param on_complete Called once the run completed, when its last task or queued data released the context.
+     */
+    explicit RunContext(std::uint64_t sequence, std::stop_token token = {},
+                        std::optional<clock::time_point> deadline = std::nullopt,
+                        std::shared_ptr<RunArena> arena = nullptr, std::function<void()> on_complete = nullptr);
+
+    ~RunContext();
+
+    RunContext(const RunContext&)            = delete;
+    RunContext& operator=(const RunContext&) = delete;
+
+    /**
+     * @brief Get the sequence number of the run.
+     * @returns The sequence number, increasing with every run of a graph.
+     */
+    [[nodiscard]] std::uint64_t Sequence() const noexcept { return _sequence; }
+
+    /**
+     * @brief Get the token used to request cancellation of the run.
+     * @returns The stop token of the run.
+     */
+    [[nodiscard]] const std::stop_token& StopToken() const noexcept { return _token; }
+
+    /**
+     * @brief Get the deadline of the run.
+     * @returns The point in time after which the run is considered cancelled, or nullopt if it has none.
+     */
+    [[nodiscard]] const std::optional<clock::time_point>& Deadline() const noexcept { return _deadline; }
+
+    /**
+     * @brief Checks if the run was cancelled, either by a stop request or by passing its deadline.
+     * @returns true if the remaining work of the run should be skipped, false otherwise.
+     */
+    [[nodiscard]] bool IsCancelled() const noexcept;
+
+    /**
+     * @brief Get the arena node data of the run is allocated from.
+     * @returns The arena of the run, or nullptr if data is allocated on the heap.
+     */
+    [[nodiscard]] const std::shared_ptr<RunArena>& Arena() const noexcept { return _arena; }
+
+    /**
+     * @brief Get the context of the run being executed on the calling thread.
+     * @returns The current run context, nullptr if the calling thread is not executing a run.
+     */
+    [[nodiscard]] static const SharedRunContext& Current() noexcept;
+
+    /**
+     * @brief Makes a run context, and its arena, current on the calling thread for the lifetime of the scope.
+     */
+    class Scope
+    {
+      public:
+        explicit Scope(SharedRunContext context) noexcept;
+        ~Scope();
+
+        Scope(const Scope&)            = delete;
+        Scope& operator=(const Scope&) = delete;
+
+      private:
+        SharedRunContext _previous;
+        RunArena::Scope _arena_scope;
+    };
+
+  private:
+    std::uint64_t _sequence;
+    std::stop_token _token;
+    std::optional<clock::time_point> _deadline;
+    std::shared_ptr<RunArena> _arena;
+    std::function<void()> _on_complete;
+};
+
+FLOW_NAMESPACE_END
@@ -0,0 +1,136 @@
+// Copyright (c) 2024, Cisco Systems, Inc.
+// All rights reserved.
+
+#pragma once
+
+#include "Core.hpp"
+#include "Graph.hpp"
+#include "IndexableName.hpp"
+#include "Node.hpp"
+#include "UUID.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+FLOW_NAMESPACE_BEGIN
+
+/**
+ * @brief Defines how a subgraph node is executed.
+ */
+enum class SubgraphMode : std::uint8_t
+{
+    /// The subgraph is computed as a single unit, scheduled like any other node of the parent graph.
+    Isolated,
+
+    /// The nodes of the subgraph are moved into the parent graph by the SubgraphFlattening pass, so that there is no
+    /// boundary between them.
+    Flattened,
+};
+
+/**
+ * @brief Node that wraps a graph, exposing ports of the nodes inside of it as its own.
+ *
+ * @details In isolated mode, computing the node sets the data of its exposed inputs on the wrapped graph, recomputes
+ *          the affected nodes of the graph on the calling thread, and emits the data of the exposed outputs.
+ */
+class SubgraphNode : public Node
+{
+  public:
+    /**
+     * @brief A port of a node inside the wrapped graph.
+     */
+    struct ExposedPort
+    {
+        /// The UUID of the node in the wrapped graph
+        UUID NodeID;
+
+        /// The key of the port on the node
+        IndexableName PortKey;
+    };
+
+    /**
+     * @brief Constructs a subgraph node.
+     *
+     * @param uuid The UUID for the node.
+     * @param name The friendly name of the node.
+     * @param env The shared environment.
+     * @param graph The graph to wrap.
+     *
+     * @throws std::invalid_argument if the graph is null.
+     */
+    explicit SubgraphNode(const UUID& uuid, const std::string& name, std::shared_ptr<Env> env,
+                          std::shared_ptr<Graph> graph);
+
+    /**
+     * @brief Get the wrapped graph.
+     * @returns The graph wrapped by the node.
+     */
+    [[nodiscard]] const std::shared_ptr<Graph>& GetGraph() const noexcept { return _graph; }
+
+    /**
+     * @brief Get the mode used to execute the subgraph.
+     * @returns The mode of the node.
+     */
+    [[nodiscard]] SubgraphMode GetMode() const noexcept { return _mode; }
+
+    /**
+     * @brief Set the mode used to execute the subgraph.
+     * @param mode The new mode of the node.
+     */
+    void SetMode(SubgraphMode mode) noexcept { _mode = mode; }
+
+    /**
+     * @brief Exposes an input port of a node in the wrapped graph as an input port of this node.
+     *
+     * @details Exposing several inner ports under the same key feeds all of them with the data of the input.
+     *
+     * @param key The key of the input port on this node.
+     * @param node The UUID of the node in the wrapped graph.
+     * @param port The key of the input port on the inner node.
+     *
+     * @throws std::invalid_argument if the node is not in the wrapped graph, or the key is already exposed with a
+     *         different type.
+     * @throws std::out_of_range if the inner node has no input port with the given key.
+     */
+    void ExposeInput(std::string_view key, const UUID& node, const IndexableName& port);
+
+    /**
+     * @brief Exposes an output port of a node in the wrapped graph as an output port of this node.
+     *
+     * @param key The key of the output port on this node.
+     * @param node The UUID of the node in the wrapped graph.
+     * @param port The key of the output port on the inner node.
+     *
+     * @throws std::invalid_argument if the node is not in the wrapped graph, or the key is already exposed.
+     * @throws std::out_of_range if the inner node has no output port with the given key.
+     */
+    void ExposeOutput(std::string_view key, const UUID& node, const IndexableName& port);
+
+    /**
+     * @brief Get the inner ports fed by each input port of this node.
+     * @returns The exposed inner input ports, keyed by the input port of this node.
+     */
+    [[nodiscard]] const auto& GetExposedInputs() const noexcept { return _exposed_inputs; }
+
+    /**
+     * @brief Get the inner port providing the data of each output port of this node.
+     * @returns The exposed inner output ports, keyed by the output port of this node.
+     */
+    [[nodiscard]] const auto& GetExposedOutputs() const noexcept { return _exposed_outputs; }
+
+  protected:
+    void Compute() override;
+
+  private:
+    std::shared_ptr<Graph> _graph;
+    SubgraphMode _mode = SubgraphMode::Isolated;
+
+    std::unordered_map<IndexableName, std::vector<ExposedPort>> _exposed_inputs;
+    std::unordered_map<IndexableName, ExposedPort> _exposed_outputs;
+};
+
+FLOW_NAMESPACE_END
@@ -0,0 +1,70 @@
+// Copyright (c) 2024, Cisco Systems, Inc.
+// All rights reserved.
+
+#pragma once
+
+#include "Core.hpp"
+#include "Env.hpp"
+#include "Node.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+FLOW_NAMESPACE_BEGIN
+
+/**
+ * @brief Source node that emits a tick counter on a fixed interval.
+ *
+ * @details The timer is armed by Start and cancelled by Stop. Each tick is computed on the thread pool of the Env,
+ *          and emits the number of ticks since the node was started on the "tick" output. Setting the "interval"
+ *          input while running re-arms the timer with the new interval.
+ */
+class TimerSourceNode : public Node
+{
+  public:
+    /**
+     * @brief Constructs a timer source node.
+     *
+     * @param uuid The UUID for the node.
+     * @param name The friendly name of the node.
+     * @param env The shared environment.
+     */
+    explicit TimerSourceNode(const UUID& uuid, const std::string& name, std::shared_ptr<Env> env);
+
+    ~TimerSourceNode() override;
+
+    void Start() override;
+    void Stop() override;
+
+    /**
+     * @brief Checks if the timer of the node is armed.
+     * @returns true if the node was started and not stopped, false otherwise.
+     */
+    [[nodiscard]] bool IsRunning() const noexcept { return _timer.has_value(); }
+
+  protected:
+    void Compute() override;
+
+    json SaveInputs() const override;
+    void RestoreInputs(const json& j) override;
+
+  private:
+    [[nodiscard]] std::chrono::milliseconds GetInterval() const;
+
+    void Arm(std::chrono::milliseconds interval);
+    void Disarm();
+    void Tick();
+
+  private:
+    /// Shared with pending timer callbacks, so that they can outlive the node.
+    struct State;
+    std::shared_ptr<State> _state;
+
+    std::optional<Env::TimerID> _timer;
+    std::chrono::milliseconds _interval{0};
+    std::uint64_t _ticks = 0;
+};
+
+FLOW_NAMESPACE_END
@@ -0,0 +1,135 @@
+// Copyright (c) 2024, Cisco Systems, Inc.
+// All rights reserved.
+
+#pragma once
+
+#include "Core.hpp"
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+FLOW_NAMESPACE_BEGIN
+
+/**
+ * @brief Hierarchical timing wheel serviced by a single thread.
+ *
+ * @details Timers are kept in a hierarchy of wheels with microsecond ticks, where each level covers 64 times the span
+ *          of the level below it. A timer is placed on the level of the highest bit in which its expiry differs from
+ *          the current time, so that adding and cancelling are O(1), and finding the next expiry only scans one
+ *          occupancy bitmap per level. Timers are moved down the levels as their expiry gets closer.
+ *
+ *          Periodic timers are re-armed relative to their previous expiry rather than to the time they fired, so that
+ *          they do not drift. When the service thread falls behind by more than a period, the missed ticks are
+ *          skipped rather than fired in a burst.
+ *
+ * @note Callbacks run on the service thread, and SHOULD hand off any real work.
+ */
+class TimerWheel
+{
+  public:
+    using clock    = std::chrono::steady_clock;
+    using Callback = std::function<void()>;
+
+    /// Identifier of a timer, only valid until the timer is cancelled or a one-shot timer has fired.
+    using TimerID = std::uint64_t;
+
+    TimerWheel();
+    ~TimerWheel();
+
+    TimerWheel(const TimerWheel&)            = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    /**
+     * @brief Adds a timer to the wheel.
+     *
+     * @param delay The time until the timer first fires.
+     * @param callback The function to call when the timer fires.
+     * @param period The time between subsequent firings, zero for a one-shot timer.
+     *
+     * @returns The identifier of the new timer.
+     */
+    TimerID Add(std::chrono::microseconds delay, Callback callback,
+                std::chrono::microseconds period = std::chrono::microseconds::zero());
+
+    /**
+     * @brief Cancels a timer.
+     *
+     * @param id The identifier of the timer.
+     *
+     * @returns true if the timer was cancelled, false if it had already fired or been cancelled.
+     */
+    bool Cancel(TimerID id);
+
+    /**
+     * @brief Get the number of timers that are currently armed.
+     * @returns The number of armed timers.
+     */
+    [[nodiscard]] std::size_t Size() const;
+
+  private:
+    /// Number of bits of the expiry covered by each level
+    static constexpr std::size_t slot_bits = 6;
+
+    /// Number of slots in a single level
+    static constexpr std::size_t slot_count = std::size_t{1} << slot_bits;
+
+    /// Number of levels needed to cover all 64 bits of the expiry
+    static constexpr std::size_t level_count = (64 + slot_bits - 1) / slot_bits;
+
+    /// Marker for the end of a slot list
+    static constexpr std::uint32_t npos = ~std::uint32_t{0};
+
+    struct Entry
+    {
+        std::uint64_t Expiry = 0;
+        std::uint64_t Period = 0;
+        std::shared_ptr<const Callback> Function;
+        std::uint32_t Previous   = npos;
+        std::uint32_t Next       = npos;
+        std::uint32_t Generation = 0;
+        std::uint8_t Level       = 0;
+        std::uint8_t Slot        = 0;
+        bool Armed               = false;
+    };
+
+    [[nodiscard]] std::uint64_t Now() const noexcept;
+
+    void Link(std::uint32_t index);
+    void Unlink(std::uint32_t index);
+    void Release(std::uint32_t index);
+
+    bool NextDeadline(std::size_t& level, std::size_t& slot, std::uint64_t& deadline) const noexcept;
+    void Advance(std::uint64_t now, std::vector<std::shared_ptr<const Callback>>& due);
+
+    void Service(std::stop_token token);
+
+  private:
+    const clock::time_point _start = clock::now();
+
+    mutable std::mutex _mutex;
+    std::condition_variable_any _cv;
+
+    /// Tick up to which all expiries have been processed
+    std::uint64_t _elapsed = 0;
+
+    /// Tick the service thread is sleeping until
+    std::uint64_t _wake = ~std::uint64_t{0};
+
+    std::vector<Entry> _entries;
+    std::vector<std::uint32_t> _free;
+    std::size_t _armed = 0;
+
+    std::array<std::array<std::uint32_t, slot_count>, level_count> _slots;
+    std::array<std::uint64_t, level_count> _occupied{};
+
+    std::jthread _thread;
+};
+
+FLOW_NAMESPACE_END
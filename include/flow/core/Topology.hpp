@@ -0,0 +1,50 @@
+// Copyright (c) 2024, Cisco Systems, Inc.
+// All rights reserved.
+
+#pragma once
+
+#include "Core.hpp"
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <vector>
+
+FLOW_NAMESPACE_BEGIN
+
+/// Set of logical CPU indices, such as a single core, the cores sharing a cache, or the cores of a NUMA node.
+using CpuSet = std::vector<std::size_t>;
+
+/**
+ * @brief Get the number of NUMA nodes of the system.
+ * @returns The number of NUMA nodes, or 1 if the topology is unknown.
+ */
+std::size_t GetNumaNodeCount();
+
+/**
+ * @brief Get the logical CPUs of a NUMA node.
+ *
+ * @param node The index of the NUMA node.
+ * @returns The CPUs of the node, or an empty set if the node does not exist or the topology is unknown.
+ */
+CpuSet GetNumaNodeCpus(std::size_t node);
+
+/**
+ * @brief Restricts the calling thread to run on the given CPUs.
+ *
+ * @param cpus The CPUs the thread may run on.
+ * @returns true if the affinity was set, false if it is unsupported on this platform or was rejected.
+ */
+bool SetCurrentThreadAffinity(std::span<const std::size_t> cpus);
+
+/**
+ * @brief Names the calling thread, as shown by debuggers and tools like top and perf.
+ *
+ * @note Names are truncated to 15 characters on Linux.
+ *
+ * @param name The name of the thread.
+ * @returns true if the name was set, false otherwise.
+ */
+bool SetCurrentThreadName(const std::string& name);
+
+FLOW_NAMESPACE_END
@@ -58,6 +58,12 @@ class TypeRegistry
     /// Function type for implementing custom type conversions
     using ConversionFunc = std::function<SharedNodeData(const SharedNodeData& data)>;
 
+    /// Function type for comparing the values of two node data of the same type
+    using EqualityFunc = std::function<bool(const SharedNodeData& lhs, const SharedNodeData& rhs)>;
+
+    /// Function type for hashing a value, given a pointer to a value of the registered type
+    using HashFunc = std::function<std::size_t(const void* value)>;
+
     /**
      * @brief Register a one-way conversion between types.
      *
@@ -121,6 +127,46 @@ class TypeRegistry
      */
     bool IsConvertible(std::string_view from_type, std::string_view to_type) const;
 
+    /**
+     * @brief Register how to compare values of a type, used for change detection on output ports.
+     *
+     * @details Types with operator== can be compared without registering them, so this is only needed for types that
+     *          lack it, or to compare with a coarser notion of equality.
+     *
+     * @tparam T The type to compare.
+     * @param equality The comparison function, defaults to comparing with operator==.
+     */
+    template<typename T>
+    void RegisterEquality(const EqualityFunc& equality = NodeDataEqual<T>);
+
+    /**
+     * @brief Get the registered comparison of a type.
+     *
+     * @param type The type name.
+     * @returns The comparison function, or nullptr if none is registered.
+     */
+    const EqualityFunc* GetEquality(std::string_view type) const;
+
+    /**
+     * @brief Register how to hash values of a type, used to key cached results of nodes.
+     *
+     * @details Types with a std::hash specialisation can be hashed without registering them, so this is only needed
+     *          for types that lack it.
+     *
+     * @tparam T The type to hash.
+     * @param hash The hash function, defaults to std::hash.
+     */
+    template<typename T>
+    void RegisterHash(std::function<std::size_t(const T&)> hash = std::hash<T>{});
+
+    /**
+     * @brief Get the registered hash of a type.
+     *
+     * @param type The type name.
+     * @returns The hash function, or nullptr if none is registered.
+     */
+    const HashFunc* GetHash(std::string_view type) const;
+
   protected:
     /**
      * @brief Internal helper to register a type conversion.
@@ -136,8 +182,28 @@ class TypeRegistry
   private:
     /// Storage for registered type conversion functions
     TypeMap<TypeMap<ConversionFunc>> _conversions;
+
+    /// Storage for registered type comparison functions
+    TypeMap<EqualityFunc> _equalities;
+
+    /// Storage for registered type hash functions
+    TypeMap<HashFunc> _hashes;
 };
 
+template<typename T>
+void TypeRegistry::RegisterEquality(const EqualityFunc& equality)
+{
+    _equalities.insert_or_assign(TypeName_v<T>, equality);
+}
+
+template<typename T>
+void TypeRegistry::RegisterHash(std::function<std::size_t(const T&)> hash)
+{
+    _hashes.insert_or_assign(TypeName_v<T>, [hash = std::move(hash)](const void* value) {
+        return hash(*static_cast<const T*>(value));
+    });
+}
+
 template<typename From, typename To>
 void TypeRegistry::RegisterConversion(const ConversionFunc& converter)
 {
@@ -8,12 +8,101 @@
 FLOW_NAMESPACE_BEGIN
 
 Connection::Connection(const UUID& start_node_id, const IndexableName& start_port_key, const UUID& end_node_id,
-                       const IndexableName& end_port_key)
+                       const IndexableName& end_port_key, std::weak_ptr<Node> consumer)
     : _id{UUID{}}, _start_node_id(start_node_id), _start_port_key{start_port_key}, _end_node_id{end_node_id},
-      _end_port_key{end_port_key}
+      _end_port_key{end_port_key}, _consumer{std::move(consumer)}
 {
 }
 
+void Connection::SetCapacity(std::size_t capacity, OverflowPolicy policy)
+{
+    std::lock_guard _(_queue_mutex);
+    _capacity = capacity;
+    _policy   = policy;
+}
+
+std::size_t Connection::GetCapacity() const
+{
+    std::lock_guard _(_queue_mutex);
+    return _capacity;
+}
+
+OverflowPolicy Connection::GetOverflowPolicy() const
+{
+    std::lock_guard _(_queue_mutex);
+    return _policy;
+}
+
+std::size_t Connection::QueueSize() const
+{
+    std::lock_guard _(_queue_mutex);
+    return _queue.size();
+}
+
+std::size_t Connection::DroppedCount() const
+{
+    std::lock_guard _(_queue_mutex);
+    return _dropped;
+}
+
+bool Connection::IsIdle() const
+{
+    std::lock_guard _(_queue_mutex);
+    return _queue.empty() && !_scheduled;
+}
+
+PushResult Connection::Push(Envelope envelope, bool overflow)
+{
+    std::lock_guard _(_queue_mutex);
+
+    if (_capacity != 0 && _queue.size() >= _capacity)
+    {
+        switch (_policy)
+        {
+        case OverflowPolicy::Block:
+            if (overflow)
+            {
+                break;
+            }
+
+            return PushResult::Full;
+        case OverflowPolicy::DropNewest:
+            ++_dropped;
+            return PushResult::Dropped;
+        case OverflowPolicy::DropOldest:
+            ++_dropped;
+            _queue.pop_front();
+            _queue.push_back(std::move(envelope));
+            return PushResult::Dropped;
+        }
+    }
+
+    _queue.push_back(std::move(envelope));
+
+    if (_scheduled)
+    {
+        return PushResult::Queued;
+    }
+
+    _scheduled = true;
+    return PushResult::Schedule;
+}
+
+bool Connection::Pop(Envelope& envelope)
+{
+    std::lock_guard _(_queue_mutex);
+
+    if (_queue.empty())
+    {
+        _scheduled = false;
+        return false;
+    }
+
+    envelope = std::move(_queue.front());
+    _queue.pop_front();
+    return true;
+}
+
 json Connection::Save() const
 {
     return {
@@ -9,9 +9,10 @@
 FLOW_NAMESPACE_BEGIN
 
 SharedConnection& Connections::Add(UUID start_id, const IndexableName& start_port_key, UUID end_id,
-                                   const IndexableName& end_port_key)
+                                   const IndexableName& end_port_key, std::weak_ptr<Node> consumer)
 {
-    auto connection = std::make_shared<Connection>(start_id, start_port_key, end_id, end_port_key);
+    auto connection =
+        std::make_shared<Connection>(start_id, start_port_key, end_id, end_port_key, std::move(consumer));
 
     std::lock_guard<std::mutex> _(_mutex);
     auto new_conn = _connections.emplace(start_id, std::move(connection));
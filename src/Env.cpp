@@ -10,12 +10,57 @@
 #include "flow/core/UUID.hpp"
 
 #include <chrono>
+#include <stdexcept>
 
 FLOW_NAMESPACE_BEGIN
 
 Env::Env(std::shared_ptr<NodeFactory> factory, const Settings& settings)
-    : _factory{std::move(factory)}, _pool{std::make_unique<thread_pool>(settings.MaxThreads)}
+    : _settings{settings}, _factory{std::move(factory)}
 {
+    auto affinity = _settings.WorkerAffinity;
+    if (affinity.empty() && _settings.NumaNode)
+    {
+        if (auto cpus = GetNumaNodeCpus(*_settings.NumaNode); !cpus.empty())
+        {
+            affinity.push_back(std::move(cpus));
+        }
+    }
+
+    auto init = [affinity = std::move(affinity), prefix = _settings.ThreadNamePrefix](std::size_t index) {
+        if (!affinity.empty())
+        {
+            SetCurrentThreadAffinity(affinity[index % affinity.size()]);
+        }
+
+        if (!prefix.empty())
+        {
+            SetCurrentThreadName(prefix + std::to_string(index));
+        }
+    };
+
+    _pool = std::make_unique<thread_pool>(_settings.MaxThreads, init);
+
+    if (_settings.SpinWorkers > 0)
+    {
+        // Number the spin workers after the pool workers, so that they get the next entries of the affinity list.
+        _spin_pool = std::make_unique<SpinPool>(
+            _settings.SpinWorkers, _settings.SpinBudget,
+            [init, offset = _pool->get_thread_count()](std::size_t index) { init(offset + index); },
+            [this](std::exception_ptr error) {
+                try
+                {
+                    std::rethrow_exception(error);
+                }
+                catch (const std::exception& e)
+                {
+                    OnError.Broadcast(e);
+                }
+                catch (...)
+                {
+                    OnError.Broadcast(std::runtime_error("Unknown exception thrown by a realtime task"));
+                }
+            });
+    }
 
     _factory->RegisterCompleteConversion<int, std::int8_t, std::int16_t, std::int32_t, std::int64_t, std::uint8_t,
                                          std::uint16_t, std::uint32_t, std::uint64_t, float, double, long double>();
@@ -25,7 +70,49 @@ Env::Env(std::shared_ptr<NodeFactory> factory, const Settings& settings)
                                          std::chrono::days, std::chrono::months, std::chrono::years>();
 }
 
-void Env::Wait() { _pool->wait(); }
+Env::~Env()
+{
+    _timers.reset();
+    Wait();
+}
+
+void Env::Wait()
+{
+    if (!_spin_pool)
+    {
+        _pool->wait();
+        return;
+    }
+
+    // Tasks on either side can queue tasks on the other, so wait until both are idle at once.
+    do
+    {
+        _pool->wait();
+        _spin_pool->Wait();
+    } while (_pool->get_tasks_total() != 0 || _spin_pool->Pending() != 0);
+}
+
+Env::TimerID Env::AddTimer(std::chrono::microseconds delay, std::function<void()> callback, priority_t priority)
+{
+    return GetTimers().Add(delay, [this, priority, callback = std::move(callback)] {
+        AddPriorityTask(priority, callback);
+    });
+}
+
+Env::TimerID Env::AddPeriodicTimer(std::chrono::microseconds period, std::function<void()> callback,
+                                   priority_t priority)
+{
+    return GetTimers().Add(
+        period, [this, priority, callback = std::move(callback)] { AddPriorityTask(priority, callback); }, period);
+}
+
+bool Env::CancelTimer(TimerID id) { return GetTimers().Cancel(id); }
+
+TimerWheel& Env::GetTimers()
+{
+    std::call_once(_timers_once, [this] { _timers = std::make_unique<TimerWheel>(); });
+    return *_timers;
+}
 
 std::string Env::GetVar(const std::string& varname) const
 {
@@ -10,23 +10,548 @@
 #include <nlohmann/json.hpp>
 
 #include <algorithm>
+#include <chrono>
+#include <deque>
+#include <optional>
 #include <set>
+#include <thread>
+#include <unordered_set>
+#include <utility>
 
 FLOW_NAMESPACE_BEGIN
 
+namespace
+{
+/// Maximum number of incomplete sequences an ordered node buffers before discarding the oldest.
+constexpr std::size_t max_reorder_window = 1024;
+
+/// Flag set while the calling thread evaluates nodes by pulling data, which keeps their outputs from being pushed.
+thread_local bool pulling = false;
+
+/// Number of nested computes the calling thread is running inline for fused connections and inline nodes.
+thread_local std::size_t inline_depth = 0;
+
+/**
+ * @brief Checks if the inline policy of a node allows computing it on the thread that produced its input data.
+ */
+bool IsInlined(const Node& node, std::chrono::nanoseconds threshold) noexcept
+{
+    if (node.GetInlinePolicy() == InlinePolicy::Auto)
+    {
+        const auto time = node.GetComputeTime();
+        return time && *time <= threshold;
+    }
+
+    return node.GetInlinePolicy() == InlinePolicy::Always;
+}
+
+/**
+ * @brief Sets the pulling flag of the calling thread for the lifetime of the scope.
+ */
+struct PullScope
+{
+    PullScope() : _previous{std::exchange(pulling, true)} {}
+    ~PullScope() { pulling = _previous; }
+
+  private:
+    bool _previous;
+};
+
+/**
+ * @brief Replaces the data made in the arena of a run, held by the ports of a node, with copies on the heap.
+ */
+void PromoteArenaData(Node& node)
+{
+    for (const auto* ports : {&node.GetInputPorts(), &node.GetOutputPorts()})
+    {
+        for (const auto& [_, port] : *ports)
+        {
+            port->Promote();
+        }
+    }
+}
+} // namespace
+
 Graph::Graph(const std::string& name, std::shared_ptr<Env> env) : _name{name}, _env{std::move(env)} {}
 
-void Graph::Run()
+void Graph::Run() { Run(std::stop_token{}); }
+
+void Graph::Run(std::stop_token token, std::optional<RunContext::clock::time_point> deadline)
 {
+    std::shared_ptr<RunArena> arena;
+    std::function<void()> on_complete;
+    if (const auto chunk_size = GetEnv()->GetSettings().RunArenaChunkSize; chunk_size != 0)
+    {
+        arena = std::make_shared<RunArena>(chunk_size);
+
+        std::vector<std::weak_ptr<Node>> nodes;
+        {
+            std::lock_guard _(_nodes_mutex);
+            nodes.reserve(_nodes.size());
+            for (const auto& [__, node] : _nodes)
+            {
+                nodes.push_back(node);
+            }
+        }
+
+        // Data made during the run stays in the arena while the run is in flight, and only the data that the ports
+        // still hold once it completed is copied to the heap. Nodes busy on the completing thread, or on another
+        // thread, are promoted by a task of their own, since the run may complete while any node is locked.
+        on_complete = [weak_env = std::weak_ptr(_env), weak_arena = std::weak_ptr(arena), nodes = std::move(nodes)] {
+            if (weak_arena.expired())
+            {
+                return;
+            }
+
+            std::vector<SharedNode> busy;
+            for (const auto& weak_node : nodes)
+            {
+                auto node = weak_node.lock();
+                if (!node)
+                {
+                    continue;
+                }
+
+                if (node->IsLockedByCurrentThread())
+                {
+                    busy.push_back(std::move(node));
+                    continue;
+                }
+
+                std::unique_lock lock(*node, std::try_to_lock);
+                if (!lock.owns_lock())
+                {
+                    busy.push_back(std::move(node));
+                    continue;
+                }
+
+                PromoteArenaData(*node);
+            }
+
+            if (auto env = weak_env.lock(); env && !busy.empty())
+            {
+                env->AddTask([busy = std::move(busy)] {
+                    for (const auto& node : busy)
+                    {
+                        std::lock_guard _(*node);
+                        PromoteArenaData(*node);
+                    }
+                });
+            }
+        };
+    }
+
+    auto context = std::make_shared<const RunContext>(++_run_sequence, std::move(token), deadline, std::move(arena),
+                                                      std::move(on_complete));
+    if (context->IsCancelled())
+    {
+        return;
+    }
+
     for (const auto& node : GetSourceNodes())
     {
-        GetEnv()->AddTask([=] {
+        Schedule(*node, [=] {
+            if (context->IsCancelled())
+            {
+                return;
+            }
+
+            RunContext::Scope scope(context);
             std::lock_guard _(*node);
             node->InvokeCompute();
         });
     }
 }
 
+SharedNodeData Graph::Evaluate(const UUID& id, const IndexableName& key)
+{
+    return Evaluate({{id, key}}).front();
+}
+
+std::vector<SharedNodeData> Graph::Evaluate(const std::vector<std::pair<UUID, IndexableName>>& outputs)
+{
+    std::vector<UUID> ids;
+    std::vector<SharedPort> ports;
+    for (const auto& [id, key] : outputs)
+    {
+        auto node = GetNode(id);
+        if (!node)
+        {
+            throw std::invalid_argument("node " + std::string(id) + " is not in graph " + _name);
+        }
+
+        ids.push_back(id);
+        ports.push_back(node->GetOutputPort(key));
+    }
+
+    EvaluateSteps(GetEvaluationSteps(ids, true));
+
+    std::vector<SharedNodeData> results;
+    results.reserve(ports.size());
+    for (std::size_t i = 0; i < ports.size(); ++i)
+    {
+        auto node = GetNode(ids[i]);
+        std::lock_guard _(*node);
+        results.push_back(ports[i]->GetData());
+    }
+
+    return results;
+}
+
+void Graph::SetInputData(const UUID& id, const IndexableName& key, SharedNodeData data)
+{
+    auto node = GetNode(id);
+    if (!node)
+    {
+        throw std::invalid_argument("node " + std::string(id) + " is not in graph " + _name);
+    }
+
+    {
+        std::lock_guard _(*node);
+        node->SetInputData(key, std::move(data), false);
+    }
+
+    std::lock_guard _(_edited_mutex);
+    _edited_nodes.push_back(id);
+}
+
+void Graph::Invalidate(const UUID& id)
+{
+    auto node = GetNode(id);
+    if (!node)
+    {
+        throw std::invalid_argument("node " + std::string(id) + " is not in graph " + _name);
+    }
+
+    node->MarkDirty();
+
+    std::lock_guard _(_edited_mutex);
+    _edited_nodes.push_back(id);
+}
+
+std::size_t Graph::Recompute()
+{
+    std::vector<UUID> edited;
+    {
+        std::lock_guard _(_edited_mutex);
+        edited.swap(_edited_nodes);
+    }
+
+    if (edited.empty())
+    {
+        return 0;
+    }
+
+    return EvaluateSteps(GetEvaluationSteps(edited, false));
+}
+
+std::vector<Graph::EvaluationStep> Graph::GetEvaluationSteps(const std::vector<UUID>& ids, bool upstream) const
+{
+    std::lock_guard _(_nodes_mutex);
+    UpdatePathLengths();
+
+    std::unordered_map<UUID, EvaluationStep> cone;
+    std::deque<UUID> pending(ids.begin(), ids.end());
+
+    while (!pending.empty())
+    {
+        const auto id = pending.front();
+        pending.pop_front();
+
+        auto found = _nodes.find(id);
+        if (cone.contains(id) || found == _nodes.end())
+        {
+            continue;
+        }
+
+        auto& step = cone[id];
+        step.Node  = found->second;
+
+        auto [begin, end] = _input_connections.equal_range(id);
+        for (auto it = begin; it != end; ++it)
+        {
+            const auto& connection = it->second;
+            auto source            = _nodes.find(connection->StartNodeID());
+            if (source == _nodes.end())
+            {
+                continue;
+            }
+
+            step.Inputs.emplace_back(connection, source->second);
+            if (upstream)
+            {
+                pending.push_back(connection->StartNodeID());
+            }
+        }
+
+        if (!upstream)
+        {
+            for (const auto& connection : _connections.FindConnections(id))
+            {
+                pending.push_back(connection->EndNodeID());
+            }
+        }
+    }
+
+    std::vector<EvaluationStep> steps;
+    steps.reserve(cone.size());
+    for (auto& [_, step] : cone)
+    {
+        steps.push_back(std::move(step));
+    }
+
+    // The nodes of a cycle are ordered by the search that found it, starting where the data enters the cycle.
+    std::sort(steps.begin(), steps.end(), [this](const auto& lhs, const auto& rhs) {
+        return _topological_order.at(lhs.Node->ID()) < _topological_order.at(rhs.Node->ID());
+    });
+
+    return steps;
+}
+
+std::size_t Graph::EvaluateSteps(const std::vector<EvaluationStep>& steps)
+{
+    struct PulledData
+    {
+        IndexableName Key;
+        SharedNodeData Data;
+        std::uint64_t Version;
+    };
+
+    PullScope scope;
+    const auto& factory = GetEnv()->GetFactory();
+
+    std::size_t computed = 0;
+    std::vector<PulledData> pulled;
+    for (const auto& [node, inputs] : steps)
+    {
+        pulled.clear();
+        for (const auto& [connection, source] : inputs)
+        {
+            std::lock_guard _(*source);
+            const auto& port = source->GetOutputPort(connection->StartPortKey());
+            pulled.push_back({connection->EndPortKey(), port->GetData(), port->GetVersion()});
+        }
+
+        std::lock_guard _(*node);
+
+        bool stale = node->IsDirty();
+        for (const auto& [key, data, version] : pulled)
+        {
+            const auto& port = node->GetInputPort(key);
+            if (port->GetVersion() == version)
+            {
+                continue;
+            }
+
+            port->SetVersion(version);
+            node->SetInputData(key, data ? factory->Convert(data, port->GetDataType()) : nullptr, false);
+            stale = true;
+        }
+
+        if (stale)
+        {
+            node->InvokeCompute();
+            ++computed;
+        }
+    }
+
+    return computed;
+}
+
+std::uint64_t Graph::CurrentSequence() noexcept
+{
+    const auto& context = RunContext::Current();
+    return context ? context->Sequence() : 0;
+}
+
+std::size_t Graph::GetRemainingPathLength(const UUID& id) const
+{
+    std::lock_guard _(_nodes_mutex);
+    UpdatePathLengths();
+
+    auto found = _path_lengths.find(id);
+    return found != _path_lengths.end() ? found->second : 0;
+}
+
+void Graph::Schedule(const Node& node, std::function<void()> task)
+{
+    _env->AddPriorityTask(GetTaskPriority(node), std::move(task));
+}
+
+priority_t Graph::GetTaskPriority(const Node& node) const
+{
+    const auto lane = node.GetPriority().value_or(GetPriority());
+    if (GetPriorityMode() == PriorityMode::Fixed)
+    {
+        return MakePriority(lane);
+    }
+
+    if (_path_lengths_dirty.load(std::memory_order_acquire))
+    {
+        std::lock_guard _(_nodes_mutex);
+        UpdatePathLengths();
+    }
+
+    return MakePriority(lane, node._path_length.load(std::memory_order_relaxed));
+}
+
+void Graph::UpdatePathLengths() const
+{
+    if (!_path_lengths_dirty.exchange(false))
+    {
+        return;
+    }
+
+    _path_lengths.clear();
+    _input_connections.clear();
+    _components.clear();
+    _topological_order.clear();
+
+    std::unordered_map<UUID, std::vector<UUID>> children;
+    for (const auto& [id, _] : _nodes)
+    {
+        auto& node_children = children[id];
+        for (const auto& connection : _connections.FindConnections(id))
+        {
+            _input_connections.emplace(connection->EndNodeID(), connection);
+            if (_nodes.contains(connection->EndNodeID()))
+            {
+                node_children.push_back(connection->EndNodeID());
+            }
+        }
+    }
+
+    // Find the strongly connected components with an iterative Tarjan search. A component is only completed after all
+    // of the components it feeds, and a node only finishes after all of the nodes it feeds outside of its component.
+    struct Frame
+    {
+        UUID ID;
+        std::size_t NextChild = 0;
+    };
+
+    std::unordered_map<UUID, std::size_t> index;
+    std::unordered_map<UUID, std::size_t> low_link;
+    std::unordered_set<UUID> on_stack;
+    std::vector<UUID> stack;
+    std::vector<Frame> frames;
+    std::vector<std::vector<UUID>> members;
+    std::size_t visited  = 0;
+    std::size_t finished = 0;
+
+    // Searching from the source nodes first enters each cycle where the data does.
+    std::vector<UUID> roots;
+    roots.reserve(_nodes.size());
+    for (const auto& [id, _] : _nodes)
+    {
+        roots.push_back(id);
+    }
+    std::stable_partition(roots.begin(), roots.end(),
+                          [this](const auto& id) { return !_input_connections.contains(id); });
+
+    for (const auto& root : roots)
+    {
+        if (index.contains(root))
+        {
+            continue;
+        }
+
+        frames.push_back({root});
+        while (!frames.empty())
+        {
+            auto& frame = frames.back();
+            const auto id = frame.ID;
+
+            if (frame.NextChild == 0 && !index.contains(id))
+            {
+                index[id] = low_link[id] = visited++;
+                stack.push_back(id);
+                on_stack.insert(id);
+            }
+
+            const auto& node_children = children[id];
+            if (frame.NextChild < node_children.size())
+            {
+                const auto& child = node_children[frame.NextChild++];
+                if (!index.contains(child))
+                {
+                    frames.push_back({child});
+                }
+                else if (on_stack.contains(child))
+                {
+                    low_link[id] = std::min(low_link[id], index[child]);
+                }
+                continue;
+            }
+
+            _topological_order[id] = finished++;
+
+            if (low_link[id] == index[id])
+            {
+                auto& component = members.emplace_back();
+                UUID member;
+                do
+                {
+                    member = stack.back();
+                    stack.pop_back();
+                    on_stack.erase(member);
+
+                    _components[member] = members.size() - 1;
+                    component.push_back(member);
+                } while (member != id);
+            }
+
+            frames.pop_back();
+            if (!frames.empty())
+            {
+                auto& parent = low_link[frames.back().ID];
+                parent       = std::min(parent, low_link[id]);
+            }
+        }
+    }
+
+    // Nodes that finish last come first, which orders the components topologically.
+    for (auto& [_, order] : _topological_order)
+    {
+        order = finished - 1 - order;
+    }
+
+    // A component is measured after all components it feeds, and all of its nodes share the longest remaining path.
+    for (std::size_t component = 0; component < members.size(); ++component)
+    {
+        std::size_t length = 0;
+        for (const auto& id : members[component])
+        {
+            for (const auto& child : children[id])
+            {
+                if (const auto child_component = _components[child]; child_component != component)
+                {
+                    length = std::max(length, _path_lengths[members[child_component].front()] + 1);
+                }
+            }
+        }
+
+        for (const auto& id : members[component])
+        {
+            _path_lengths[id] = length;
+        }
+    }
+
+    for (const auto& [id, node] : _nodes)
+    {
+        node->_path_length.store(_path_lengths[id], std::memory_order_relaxed);
+    }
+}
+
+bool Graph::IsOnCycle(const Connection& conn) const
+{
+    std::lock_guard _(_nodes_mutex);
+    UpdatePathLengths();
+
+    auto start = _components.find(conn.StartNodeID());
+    auto end   = _components.find(conn.EndNodeID());
+    return start != _components.end() && end != _components.end() && start->second == end->second;
+}
+
 void Graph::Visit(const VisitorFunction& visitor)
 {
     if (_nodes.empty())
@@ -89,6 +614,7 @@ void Graph::AddNode(SharedNode node)
     {
         std::lock_guard _(_nodes_mutex);
         _nodes.emplace(node->ID(), node);
+        _path_lengths_dirty = true;
     }
 
     node->_propagate_output_update = [this](const UUID& id, const IndexableName& key, SharedNodeData data) {
@@ -110,6 +636,7 @@ void Graph::RemoveNodeByID(const UUID& uuid)
     std::lock_guard _(_nodes_mutex);
 
     _connections.RemoveByNodeID(uuid);
+    _path_lengths_dirty = true;
 
     auto found = _nodes.find(uuid);
     if (found != _nodes.end())
@@ -200,6 +727,45 @@ std::vector<SharedNode> Graph::GetOrphanNodes() const
     return orphans;
 }
 
+std::size_t Graph::MemoryUsage() const
+{
+    std::vector<SharedNode> nodes;
+    {
+        std::lock_guard _(_nodes_mutex);
+        nodes.reserve(_nodes.size());
+        for (const auto& [__, node] : _nodes)
+        {
+            nodes.push_back(node);
+        }
+    }
+
+    std::size_t usage = 0;
+    std::unordered_set<const INodeData*> counted;
+    for (const auto& node : nodes)
+    {
+        std::lock_guard _(*node);
+        for (const auto* ports : {&node->GetInputPorts(), &node->GetOutputPorts()})
+        {
+            for (const auto& [__, port] : *ports)
+            {
+                // Spilled data is not in memory, and reading it back just to measure it would defeat the spill.
+                if (port->IsSpilled())
+                {
+                    continue;
+                }
+
+                const auto& data = port->GetData();
+                if (data && counted.insert(data.get()).second)
+                {
+                    usage += data->SizeInBytes();
+                }
+            }
+        }
+    }
+
+    return usage;
+}
+
 bool Graph::CanConnectNode(const UUID& start, const IndexableName& start_key, const UUID& end,
                           const IndexableName& end_key)
 {
@@ -268,7 +834,9 @@ SharedConnection Graph::ConnectNodes(const UUID& start_id, const IndexableName&
     end_port->Connect();
 
     // Create the connection
-    auto&& conn = _connections.Add(start_id, start_port->GetVarName(), end_id, end_port->GetVarName());
+    auto&& conn = _connections.Add(start_id, start_port->GetVarName(), end_id, end_port->GetVarName(), out_node);
+
+    _path_lengths_dirty = true;
     
     // Propagate existing data if any
     if (auto data = in_node->GetOutputData(start_port_key))
@@ -297,7 +865,8 @@ void Graph::DisconnectNodes(const UUID& start_id, const IndexableName& start_por
 
     OnNodesDisconnected.Broadcast(*found_conn);
 
-    _connections.Remove(start_id, end_id);
+    _connections.Remove((*found_conn)->ID());
+    _path_lengths_dirty = true;
 
     auto in_node  = GetNode(start_id);
     auto out_node = GetNode(end_id);
@@ -320,41 +889,311 @@ void Graph::DisconnectNodes(const UUID& start_id, const IndexableName& start_por
 
 void Graph::PropagateConnectionsData(const UUID& id, const IndexableName& key, SharedNodeData data)
 {
-    const auto& factory = GetEnv()->GetFactory();
+    if (pulling)
+    {
+        return;
+    }
+
+    const auto& context = RunContext::Current();
+    if (context && context->IsCancelled())
+    {
+        return;
+    }
 
     auto connections = _connections.FindConnections(id, key);
-    for (auto it = connections.begin(); it != connections.end(); ++it)
+    for (const auto& conn : connections)
     {
-        std::weak_ptr<Connection> connection = *it;
+        // Taken from the connection rather than the graph, so that emitting data does not contend on the node map.
+        auto consumer = conn->GetConsumer();
+        if (!consumer)
+        {
+            continue;
+        }
 
-        _env->AddTask([=, this, in_data = data] {
-            try
+        if (DeliverInline(conn, consumer, data))
+        {
+            continue;
+        }
+
+        // The producer is locked by the calling thread, so the consumer is only computed here when that cannot wait on
+        // a node further up the stack, or a node held by another thread. Otherwise, the producer backs off until the
+        // task delivering the queue frees space. A consumer locked further up the stack can never take data while
+        // the producer waits, such as in a cycle, so the data is queued beyond the capacity instead. On a cycle, the
+        // consumer can also be held by another thread that waits for space on the way back to the producer, so the
+        // data is queued beyond the capacity once the producer waited for the cycle block timeout.
+        PushResult result;
+        std::optional<std::chrono::steady_clock::time_point> deadline;
+        while ((result = conn->Push({data, context})) == PushResult::Full)
+        {
+            if (consumer->IsLockedByCurrentThread())
             {
-                auto conn = connection.lock();
-                if (!conn)
-                {
-                    return;
-                }
+                result = conn->Push({data, context}, true);
+                break;
+            }
 
-                std::lock_guard conn_lock(*conn);
+            if (DeliverNext(conn, false))
+            {
+                continue;
+            }
 
-                auto node = GetNode(conn->EndNodeID());
-                if (!node)
+            if (!deadline)
+            {
+                deadline = IsOnCycle(*conn)
+                               ? std::chrono::steady_clock::now() + _env->GetSettings().CycleBlockTimeout
+                               : std::chrono::steady_clock::time_point::max();
+            }
+
+            if (std::chrono::steady_clock::now() >= *deadline)
+            {
+                result = conn->Push({data, context}, true);
+                break;
+            }
+
+            std::this_thread::yield();
+        }
+
+        if (result != PushResult::Schedule)
+        {
+            continue;
+        }
+
+        std::weak_ptr<Connection> connection = conn;
+        Schedule(*consumer, [=, this] {
+            if (auto conn = connection.lock())
+            {
+                while (DeliverNext(conn))
                 {
-                    return;
                 }
+            }
+        });
+    }
+}
 
-                std::lock_guard _(*node);
-                const auto& port    = node->GetInputPort(conn->EndPortKey());
-                auto converted_data = factory->Convert(in_data, port->GetDataType());
+bool Graph::DeliverNext(const SharedConnection& conn, bool wait)
+{
+    auto node = conn->GetConsumer();
+    std::unique_lock<Node> node_lock;
+    std::unique_lock<Connection> conn_lock(*conn, std::defer_lock);
 
-                node->SetInputData(conn->EndPortKey(), std::move(converted_data));
+    if (wait)
+    {
+        conn_lock.lock();
+    }
+    else if (!conn_lock.try_lock())
+    {
+        return false;
+    }
+
+    // Without waiting, the node is locked before taking data from the queue, so that no data is lost if it is busy.
+    if (!wait && node && node->GetInputMode() != InputMode::Conflating)
+    {
+        if (node->IsLockedByCurrentThread() || !(node_lock = std::unique_lock<Node>(*node, std::try_to_lock)))
+        {
+            return false;
+        }
+    }
+
+    Envelope envelope;
+    if (!conn->Pop(envelope))
+    {
+        return false;
+    }
+
+    if (envelope.Context && envelope.Context->IsCancelled())
+    {
+        return true;
+    }
+
+    try
+    {
+        if (!node)
+        {
+            return true;
+        }
+
+        const auto& factory = GetEnv()->GetFactory();
+        const auto& port    = node->GetInputPort(conn->EndPortKey());
+
+        if (node->GetInputMode() == InputMode::Conflating)
+        {
+            port->SetPendingData(factory->Convert(envelope.Data, port->GetDataType()));
+            node->_pending_context.store(envelope.Context);
+
+            if (!node->_compute_scheduled.exchange(true))
+            {
+                std::weak_ptr<Node> weak_node = node;
+                Schedule(*node, [=] {
+                    if (auto node = weak_node.lock())
+                    {
+                        ComputePendingInputs(node);
+                    }
+                });
             }
-            catch (const std::exception& e)
+
+            return true;
+        }
+
+        if (!node_lock)
+        {
+            node_lock = std::unique_lock<Node>(*node);
+        }
+
+        auto converted_data = factory->Convert(envelope.Data, port->GetDataType());
+
+        if (node->GetInputMode() == InputMode::Ordered && envelope.Context)
+        {
+            DeliverOrdered(node, conn->EndPortKey(), std::move(converted_data), std::move(envelope.Context));
+            return true;
+        }
+
+        RunContext::Scope scope(std::move(envelope.Context));
+        node->SetInputData(conn->EndPortKey(), std::move(converted_data));
+    }
+    catch (const std::exception& e)
+    {
+        OnError.Broadcast(e);
+    }
+
+    return true;
+}
+
+bool Graph::DeliverInline(const SharedConnection& conn, const SharedNode& node, const SharedNodeData& data)
+{
+    if (inline_depth >= _env->GetSettings().MaxInlineDepth)
+    {
+        return false;
+    }
+
+    if (node->GetInputMode() != InputMode::Queued)
+    {
+        return false;
+    }
+
+    if (!conn->IsFused() && !IsInlined(*node, _env->GetSettings().InlineThreshold))
+    {
+        return false;
+    }
+
+    // Data delivered inline would overtake the data queued before it, and skip the capacity and overflow policy of a
+    // bounded connection.
+    if (conn->GetCapacity() != 0 || !conn->IsIdle())
+    {
+        return false;
+    }
+
+    // The producer is locked by the calling thread, so waiting on the consumer could deadlock with a thread that holds
+    // the consumer and waits on the producer, or with a consumer locked further up the stack. The data is queued then.
+    if (node->IsLockedByCurrentThread())
+    {
+        return false;
+    }
+
+    std::unique_lock lock(*node, std::try_to_lock);
+    if (!lock)
+    {
+        return false;
+    }
+
+    ++inline_depth;
+    try
+    {
+        const auto& port = node->GetInputPort(conn->EndPortKey());
+        node->SetInputData(conn->EndPortKey(), GetEnv()->GetFactory()->Convert(data, port->GetDataType()));
+    }
+    catch (const std::exception& e)
+    {
+        OnError.Broadcast(e);
+    }
+    --inline_depth;
+
+    return true;
+}
+
+void Graph::ComputePendingInputs(const SharedNode& node)
+{
+    std::lock_guard _(*node);
+
+    // Cleared before taking the inputs, so that data arriving from here on schedules another compute.
+    node->_compute_scheduled = false;
+
+    auto context = node->_pending_context.load();
+    if (context && context->IsCancelled())
+    {
+        return;
+    }
+
+    RunContext::Scope scope(std::move(context));
+
+    for (const auto& [key, port] : node->GetInputPorts())
+    {
+        SharedNodeData data;
+        if (port->TakePendingData(data))
+        {
+            node->SetInputData(key, std::move(data), false);
+        }
+    }
+
+    node->InvokeCompute();
+}
+
+void Graph::DeliverOrdered(const SharedNode& node, const IndexableName& key, SharedNodeData data,
+                           SharedRunContext context)
+{
+    const auto sequence = context->Sequence();
+    if (sequence <= node->_last_sequence)
+    {
+        return;
+    }
+
+    auto& buffer  = node->_ordered_inputs;
+    auto& entry   = buffer[sequence];
+    entry.Context = std::move(context);
+    entry.Data.insert_or_assign(key, std::move(data));
+
+    auto& latest = node->_latest_sequences[key];
+    latest       = std::max(latest, sequence);
+
+    while (buffer.size() > max_reorder_window)
+    {
+        buffer.erase(buffer.begin());
+    }
+
+    const auto& ports       = node->GetInputPorts();
+    // Values of each connection arrive in sequence order, so an input that already received a later sequence skipped
+    // this one, and keeps its current value.
+    const auto& is_complete = [&](const auto& entry) {
+        return std::all_of(ports.begin(), ports.end(), [&](const auto& port) {
+            if (!port.second->IsConnected() || entry.second.Data.contains(port.first))
             {
-                OnError.Broadcast(e);
+                return true;
             }
+
+            auto found = node->_latest_sequences.find(port.first);
+            return found != node->_latest_sequences.end() && found->second > entry.first;
         });
+    };
+
+    for (auto ready = std::find_if(buffer.begin(), buffer.end(), is_complete); ready != buffer.end();
+         ready      = std::find_if(buffer.begin(), buffer.end(), is_complete))
+    {
+        auto [ready_sequence, inputs] = std::move(*ready);
+
+        // Anything older than the ready sequence is incomplete, and computing it later would break the ordering.
+        buffer.erase(buffer.begin(), std::next(ready));
+        node->_last_sequence = ready_sequence;
+
+        if (inputs.Context->IsCancelled())
+        {
+            continue;
+        }
+
+        RunContext::Scope scope(std::move(inputs.Context));
+        for (auto& [input_key, input_data] : inputs.Data)
+        {
+            node->SetInputData(input_key, std::move(input_data), false);
+        }
+
+        node->InvokeCompute();
     }
 }
 
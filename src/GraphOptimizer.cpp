@@ -0,0 +1,495 @@
+// Copyright (c) 2024, Cisco Systems, Inc.
+// All rights reserved.
+
+#include "flow/core/GraphOptimizer.hpp"
+
+#include "flow/core/Env.hpp"
+#include "flow/core/NodeFactory.hpp"
+#include "flow/core/SubgraphNode.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+
+FLOW_NAMESPACE_BEGIN
+
+namespace
+{
+using InputConnections = std::unordered_map<UUID, std::vector<SharedConnection>>;
+
+InputConnections GetInputConnections(const Graph& graph)
+{
+    InputConnections inputs;
+    for (const auto& [_, connection] : graph.GetConnections())
+    {
+        inputs[connection->EndNodeID()].push_back(connection);
+    }
+
+    return inputs;
+}
+
+std::string Describe(const SharedNode& node) { return node->GetName() + " (" + std::string(node->ID()) + ")"; }
+
+void Disconnect(Graph& graph, const SharedConnection& connection)
+{
+    graph.DisconnectNodes(connection->StartNodeID(), connection->StartPortKey(), connection->EndNodeID(),
+                          connection->EndPortKey());
+}
+
+/**
+ * @brief Removes a node from the graph along with all of its connections.
+ */
+void RemoveNode(Graph& graph, const SharedNode& node, const std::vector<SharedConnection>& inputs,
+                OptimizationReport& report)
+{
+    for (const auto& connection : inputs)
+    {
+        Disconnect(graph, connection);
+    }
+
+    for (const auto& connection : graph.GetConnections().FindConnections(node->ID()))
+    {
+        Disconnect(graph, connection);
+    }
+
+    graph.RemoveNodeByID(node->ID());
+    report.RemovedNodes.push_back(node->ID());
+}
+
+bool IsFoldable(const SharedNode& node)
+{
+    if (!node->IsPure())
+    {
+        return false;
+    }
+
+    const auto& inputs = node->GetInputPorts();
+    if (!std::all_of(inputs.begin(), inputs.end(),
+                     [](const auto& input) { return !input.second->IsConnected() && input.second->GetData(); }))
+    {
+        return false;
+    }
+
+    const auto& outputs  = node->GetOutputPorts();
+    const auto required  = [](const auto& output) { return output.second->IsRequired(); };
+    const auto connected = [](const auto& output) { return output.second->IsConnected(); };
+
+    return std::none_of(outputs.begin(), outputs.end(), required) &&
+           std::any_of(outputs.begin(), outputs.end(), connected);
+}
+
+bool SameConstant(const SharedPort& lhs, const SharedPort& rhs)
+{
+    const auto& lhs_data = lhs->GetData();
+    const auto& rhs_data = rhs->GetData();
+    if (!lhs_data || !rhs_data || lhs_data == rhs_data)
+    {
+        return lhs_data == rhs_data;
+    }
+
+    return lhs->GetEquality() && lhs_data->Type() == rhs_data->Type() && lhs->GetEquality()(lhs_data, rhs_data);
+}
+
+/**
+ * @brief Checks if a node can be reached from another by following the connections of the graph.
+ */
+bool Reaches(const Graph& graph, const UUID& from, const UUID& to)
+{
+    std::unordered_set<UUID> visited;
+    std::deque<UUID> pending{from};
+
+    while (!pending.empty())
+    {
+        const auto id = pending.front();
+        pending.pop_front();
+
+        if (id == to)
+        {
+            return true;
+        }
+
+        if (!visited.insert(id).second)
+        {
+            continue;
+        }
+
+        for (const auto& connection : graph.GetConnections().FindConnections(id))
+        {
+            pending.push_back(connection->EndNodeID());
+        }
+    }
+
+    return false;
+}
+} // namespace
+
+bool GraphPass::IsObserved(const UUID& id) const
+{
+    return std::any_of(_observed.begin(), _observed.end(), [&](const auto& observed) { return observed.first == id; });
+}
+
+void SubgraphFlattening::Run(Graph& graph, OptimizationReport& report)
+{
+    // The connections change with each flattened subgraph, and moved nodes can be flattened subgraphs themselves, so
+    // start over after each one until none are left.
+    bool flattened = true;
+    while (flattened)
+    {
+        flattened = false;
+
+        const auto nodes  = graph.GetNodes();
+        const auto inputs = GetInputConnections(graph);
+        for (const auto& [id, node] : nodes)
+        {
+            auto subgraph = std::dynamic_pointer_cast<SubgraphNode>(node);
+            if (!subgraph || subgraph->GetMode() != SubgraphMode::Flattened || IsObserved(id))
+            {
+                continue;
+            }
+
+            const auto& inner   = subgraph->GetGraph();
+            const auto found    = inputs.find(id);
+            const auto incoming = found != inputs.end() ? found->second : std::vector<SharedConnection>{};
+            const auto outgoing = graph.GetConnections().FindConnections(id);
+
+            std::vector<std::pair<IndexableName, SharedNodeData>> constants;
+            for (const auto& [key, port] : subgraph->GetInputPorts())
+            {
+                if (!port->IsConnected() && port->GetData())
+                {
+                    constants.emplace_back(key, port->GetData());
+                }
+            }
+
+            RemoveNode(graph, subgraph, incoming, report);
+
+            // Move the inner nodes and connections, releasing the inner ports so they can be connected again.
+            const auto inner_nodes = inner->GetNodes();
+            std::vector<SharedConnection> inner_connections;
+            for (const auto& [_, connection] : inner->GetConnections())
+            {
+                inner_connections.push_back(connection);
+                inner_nodes.at(connection->StartNodeID())->GetOutputPort(connection->StartPortKey())->Disconnect();
+                inner_nodes.at(connection->EndNodeID())->GetInputPort(connection->EndPortKey())->Disconnect();
+            }
+
+            inner->Clear();
+
+            for (const auto& [_, inner_node] : inner_nodes)
+            {
+                graph.AddNode(inner_node);
+            }
+
+            for (const auto& connection : inner_connections)
+            {
+                if (auto moved = graph.ConnectNodes(connection->StartNodeID(), connection->StartPortKey(),
+                                                    connection->EndNodeID(), connection->EndPortKey()))
+                {
+                    moved->SetCapacity(connection->GetCapacity(), connection->GetOverflowPolicy());
+                    moved->SetFused(connection->IsFused());
+                }
+            }
+
+            const auto& exposed_inputs = subgraph->GetExposedInputs();
+            for (const auto& connection : incoming)
+            {
+                for (const auto& target : exposed_inputs.at(connection->EndPortKey()))
+                {
+                    graph.ConnectNodes(connection->StartNodeID(), connection->StartPortKey(), target.NodeID,
+                                       target.PortKey);
+                }
+            }
+
+            for (const auto& [key, data] : constants)
+            {
+                for (const auto& target : exposed_inputs.at(key))
+                {
+                    const auto& target_node = inner_nodes.at(target.NodeID);
+
+                    std::lock_guard _(*target_node);
+                    target_node->SetInputData(target.PortKey, data, false);
+                }
+            }
+
+            for (const auto& connection : outgoing)
+            {
+                const auto& source = subgraph->GetExposedOutputs().at(connection->StartPortKey());
+                graph.ConnectNodes(source.NodeID, source.PortKey, connection->EndNodeID(), connection->EndPortKey());
+            }
+
+            report.Changes.push_back("flattened " + Describe(subgraph) + " into " + std::to_string(inner_nodes.size()) +
+                                     " nodes");
+            flattened = true;
+            break;
+        }
+    }
+}
+
+void DeadNodeElimination::Run(Graph& graph, OptimizationReport& report)
+{
+    const auto nodes  = graph.GetNodes();
+    const auto inputs = GetInputConnections(graph);
+
+    std::unordered_set<UUID> live;
+    std::deque<UUID> pending;
+
+    for (const auto& [id, node] : nodes)
+    {
+        if (node->GetOutputPorts().empty())
+        {
+            pending.push_back(id);
+        }
+    }
+
+    for (const auto& [id, key] : GetObserved())
+    {
+        auto found = nodes.find(id);
+        if (found != nodes.end() && found->second->GetOutputPorts().contains(key))
+        {
+            pending.push_back(id);
+        }
+    }
+
+    while (!pending.empty())
+    {
+        const auto id = pending.front();
+        pending.pop_front();
+
+        if (!live.insert(id).second)
+        {
+            continue;
+        }
+
+        if (auto found = inputs.find(id); found != inputs.end())
+        {
+            for (const auto& connection : found->second)
+            {
+                pending.push_back(connection->StartNodeID());
+            }
+        }
+    }
+
+    for (const auto& [id, node] : nodes)
+    {
+        if (live.contains(id))
+        {
+            continue;
+        }
+
+        auto found = inputs.find(id);
+        RemoveNode(graph, node, found != inputs.end() ? found->second : std::vector<SharedConnection>{}, report);
+        report.Changes.push_back("removed " + Describe(node) + ", its outputs reach no leaf or observed port");
+    }
+}
+
+void ConstantFolding::Run(Graph& graph, OptimizationReport& report)
+{
+    const auto& factory = graph.GetEnv()->GetFactory();
+
+    // Folding a node turns the inputs of its children into constants, so repeat until nothing else can be folded.
+    bool folded = true;
+    while (folded)
+    {
+        folded = false;
+
+        const auto nodes = graph.GetNodes();
+        for (const auto& [id, node] : nodes)
+        {
+            if (!IsFoldable(node) || IsObserved(id))
+            {
+                continue;
+            }
+
+            std::vector<std::pair<UUID, IndexableName>> outputs;
+            for (const auto& [key, _] : node->GetOutputPorts())
+            {
+                outputs.emplace_back(id, key);
+            }
+
+            const auto results = graph.Evaluate(outputs);
+            if (std::any_of(results.begin(), results.end(), [](const auto& data) { return !data; }))
+            {
+                continue;
+            }
+
+            for (std::size_t i = 0; i < outputs.size(); ++i)
+            {
+                for (const auto& connection : graph.GetConnections().FindConnections(id, outputs[i].second))
+                {
+                    Disconnect(graph, connection);
+
+                    auto child = graph.GetNode(connection->EndNodeID());
+                    if (!child)
+                    {
+                        continue;
+                    }
+
+                    std::lock_guard _(*child);
+                    const auto& key  = connection->EndPortKey();
+                    const auto& port = child->GetInputPort(key);
+                    child->SetInputData(key, factory->Convert(results[i], port->GetType()), false);
+                }
+            }
+
+            RemoveNode(graph, node, {}, report);
+            report.Changes.push_back("folded " + Describe(node) + " into constant inputs of its children");
+            folded = true;
+        }
+    }
+}
+
+void CommonSubexpressionElimination::Run(Graph& graph, OptimizationReport& report)
+{
+    std::vector<SharedNode> nodes;
+    std::unordered_map<UUID, std::size_t> path_lengths;
+    for (const auto& [id, node] : graph.GetNodes())
+    {
+        nodes.push_back(node);
+        path_lengths[id] = graph.GetRemainingPathLength(id);
+    }
+
+    std::sort(nodes.begin(), nodes.end(),
+              [&](const auto& lhs, const auto& rhs) { return path_lengths[lhs->ID()] > path_lengths[rhs->ID()]; });
+
+    auto inputs = GetInputConnections(graph);
+    std::unordered_map<std::string, std::vector<SharedNode>> candidates;
+
+    for (const auto& node : nodes)
+    {
+        if (!node->IsPure())
+        {
+            continue;
+        }
+
+        const bool observed = IsObserved(node->ID());
+
+        std::vector<SharedPort> ports;
+        for (const auto& [_, port] : node->GetInputPorts())
+        {
+            ports.push_back(port);
+        }
+
+        // Sorted in declaration order, so that the signature does not depend on where the ports were allocated.
+        std::sort(ports.begin(), ports.end(),
+                  [](const auto& lhs, const auto& rhs) { return lhs->Index() < rhs->Index(); });
+
+        // Connected inputs are part of the signature, constants are compared with the candidates.
+        const auto& connections = inputs[node->ID()];
+        std::string signature   = node->GetClass();
+        for (const auto& port : ports)
+        {
+            signature += '|';
+            signature += port->GetVarName();
+
+            auto connection = std::find_if(connections.begin(), connections.end(),
+                                           [&](const auto& c) { return c->EndPortKey() == port->GetKey(); });
+            if (connection != connections.end())
+            {
+                signature += '=' + std::string((*connection)->StartNodeID()) + ':';
+                signature += std::string_view((*connection)->StartPortKey());
+            }
+        }
+
+        auto& matches = candidates[signature];
+        auto match    = std::find_if(matches.begin(), matches.end(), [&](const SharedNode& candidate) {
+            return std::all_of(ports.begin(), ports.end(), [&](const auto& port) {
+                return port->IsConnected() || SameConstant(port, candidate->GetInputPort(port->GetKey()));
+            });
+        });
+
+        if (match == matches.end() || (observed && IsObserved((*match)->ID())))
+        {
+            matches.push_back(node);
+            continue;
+        }
+
+        // An observed node takes the place of the candidate it matches, rather than being merged into it.
+        auto merged   = node;
+        auto original = *match;
+        if (observed)
+        {
+            std::swap(merged, original);
+            *match = original;
+        }
+
+        for (const auto& connection : graph.GetConnections().FindConnections(merged->ID()))
+        {
+            Disconnect(graph, connection);
+
+            auto moved = graph.ConnectNodes(original->ID(), connection->StartPortKey(), connection->EndNodeID(),
+                                            connection->EndPortKey());
+
+            auto& child_inputs = inputs[connection->EndNodeID()];
+            std::erase(child_inputs, connection);
+            if (moved)
+            {
+                child_inputs.push_back(std::move(moved));
+            }
+        }
+
+        RemoveNode(graph, merged, inputs[merged->ID()], report);
+        report.Changes.push_back("merged " + Describe(merged) + " into " + Describe(original));
+    }
+}
+
+void NodeFusion::Run(Graph& graph, OptimizationReport& report)
+{
+    const auto inputs = GetInputConnections(graph);
+
+    for (const auto& [producer_id, connection] : graph.GetConnections())
+    {
+        auto producer = graph.GetNode(producer_id);
+        auto consumer = graph.GetNode(connection->EndNodeID());
+        if (!(producer && consumer) || connection->IsFused() || connection->GetCapacity() != 0 ||
+            consumer->GetInputMode() != InputMode::Queued)
+        {
+            continue;
+        }
+
+        if (graph.GetConnections().FindConnections(producer_id).size() != 1 || inputs.at(consumer->ID()).size() != 1)
+        {
+            continue;
+        }
+
+        // Inside a cycle, computing the consumer inline would lock the nodes of the cycle in turn on a single stack.
+        if (Reaches(graph, consumer->ID(), producer_id))
+        {
+            continue;
+        }
+
+        connection->SetFused(true);
+        report.Changes.push_back("fused " + Describe(producer) + " with " + Describe(consumer));
+    }
+}
+
+GraphOptimizer GraphOptimizer::CreateDefault(GraphPass::ObservedPorts observed)
+{
+    GraphOptimizer optimizer;
+    optimizer.AddPass<SubgraphFlattening>(observed);
+    optimizer.AddPass<ConstantFolding>(observed);
+    optimizer.AddPass<CommonSubexpressionElimination>(observed);
+    optimizer.AddPass<DeadNodeElimination>(observed);
+    optimizer.AddPass<NodeFusion>(std::move(observed));
+
+    return optimizer;
+}
+
+void GraphOptimizer::AddPass(std::unique_ptr<GraphPass> pass) { _passes.push_back(std::move(pass)); }
+
+std::vector<OptimizationReport> GraphOptimizer::Run(Graph& graph) const
+{
+    std::vector<OptimizationReport> reports;
+    reports.reserve(_passes.size());
+
+    for (const auto& pass : _passes)
+    {
+        auto& report = reports.emplace_back();
+        report.Pass  = pass->GetName();
+        pass->Run(graph, report);
+    }
+
+    return reports;
+}
+
+FLOW_NAMESPACE_END
@@ -0,0 +1,289 @@
+// Copyright (c) 2024, Cisco Systems, Inc.
+// All rights reserved.
+
+#include "flow/core/GraphTemplate.hpp"
+
+#include "flow/core/Env.hpp"
+#include "flow/core/NodeFactory.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <latch>
+#include <stdexcept>
+
+FLOW_NAMESPACE_BEGIN
+
+GraphTemplate::GraphTemplate(std::shared_ptr<Graph> graph) : _graph{std::move(graph)}
+{
+    std::vector<SharedNode> nodes;
+    std::unordered_map<UUID, std::size_t> path_lengths;
+    for (const auto& [id, node] : _graph->GetNodes())
+    {
+        nodes.push_back(node);
+        path_lengths[id] = _graph->GetRemainingPathLength(id);
+    }
+
+    // A node is always further from the leaves than the nodes it feeds, so this is a topological order.
+    std::sort(nodes.begin(), nodes.end(),
+              [&](const auto& lhs, const auto& rhs) { return path_lengths[lhs->ID()] > path_lengths[rhs->ID()]; });
+
+    const auto assign_slots = [this](const auto& ports, auto& slots) {
+        std::vector<SharedPort> sorted;
+        for (const auto& [_, port] : ports)
+        {
+            sorted.push_back(port);
+        }
+
+        std::sort(sorted.begin(), sorted.end(),
+                  [](const auto& lhs, const auto& rhs) { return lhs->Index() < rhs->Index(); });
+        for (const auto& port : sorted)
+        {
+            slots.emplace_back(port->GetKey(), _defaults.size());
+            _defaults.push_back(port->GetData());
+        }
+    };
+
+    for (const auto& node : nodes)
+    {
+        _node_steps.emplace(node->ID(), _steps.size());
+
+        auto& step     = _steps.emplace_back();
+        step.Prototype = node;
+        assign_slots(node->GetInputPorts(), step.Inputs);
+        assign_slots(node->GetOutputPorts(), step.Outputs);
+
+        // Instances hand data across the connections themselves.
+        node->_propagate_output_update = [](const UUID&, const IndexableName&, const SharedNodeData&) {};
+    }
+
+    _edges.resize(_defaults.size());
+    for (const auto& [_, connection] : _graph->GetConnections())
+    {
+        const auto [start_step, start_slot] = FindSlot(connection->StartNodeID(), connection->StartPortKey(), false);
+        const auto [end_step, end_slot]     = FindSlot(connection->EndNodeID(), connection->EndPortKey(), true);
+
+        const auto& end_port = _steps[end_step].Prototype->GetInputPort(connection->EndPortKey());
+        _edges[start_slot].push_back({end_step, end_slot, end_port->GetType()});
+    }
+}
+
+std::shared_ptr<const GraphTemplate> GraphTemplate::Create(std::shared_ptr<Graph> graph)
+{
+    if (!graph)
+    {
+        throw std::invalid_argument("a graph template requires a graph");
+    }
+
+    return std::shared_ptr<const GraphTemplate>(new GraphTemplate(std::move(graph)));
+}
+
+std::shared_ptr<GraphInstance> GraphTemplate::Instantiate() const
+{
+    return std::shared_ptr<GraphInstance>(new GraphInstance(shared_from_this()));
+}
+
+std::vector<std::vector<SharedNodeData>> GraphTemplate::RunBatch(
+    const std::vector<RunInputs>& inputs, const std::vector<std::pair<UUID, IndexableName>>& outputs,
+    Priority priority) const
+{
+    for (const auto& [id, key] : outputs)
+    {
+        std::ignore = FindSlot(id, key, false);
+    }
+
+    // Shared with the tasks, so that nothing they use is left dangling if the caller unwinds before they ran.
+    struct Batch
+    {
+        explicit Batch(std::size_t size, std::vector<std::pair<UUID, IndexableName>> outputs)
+            : Outputs{std::move(outputs)}, Results(size), Errors(size), Done{static_cast<std::ptrdiff_t>(size)}
+        {
+            Instances.reserve(size);
+        }
+
+        std::vector<std::shared_ptr<GraphInstance>> Instances;
+        std::vector<std::pair<UUID, IndexableName>> Outputs;
+        std::vector<std::vector<SharedNodeData>> Results;
+        std::vector<std::exception_ptr> Errors;
+        std::atomic<std::size_t> Next = 0;
+        std::latch Done;
+    };
+
+    auto batch = std::make_shared<Batch>(inputs.size(), outputs);
+    for (const auto& run_inputs : inputs)
+    {
+        auto& instance = batch->Instances.emplace_back(Instantiate());
+        for (const auto& [id, key, data] : run_inputs)
+        {
+            instance->SetInputData(id, key, data);
+        }
+    }
+
+    // Each task, and the caller, takes runs that did not start yet until none are left.
+    const auto work = [](Batch& batch) {
+        for (std::size_t i = 0; (i = batch.Next++) < batch.Instances.size();)
+        {
+            struct CountDown
+            {
+                std::latch& Done;
+                ~CountDown() { Done.count_down(); }
+            } count_down{batch.Done};
+
+            try
+            {
+                batch.Instances[i]->Run();
+
+                auto& result = batch.Results[i];
+                result.reserve(batch.Outputs.size());
+                for (const auto& [id, key] : batch.Outputs)
+                {
+                    result.push_back(batch.Instances[i]->GetOutputData(id, key));
+                }
+            }
+            catch (...)
+            {
+                batch.Errors[i] = std::current_exception();
+            }
+        }
+    };
+
+    for (std::size_t i = 1; i < batch->Instances.size(); ++i)
+    {
+        GetEnv()->AddPriorityTask(MakePriority(priority), [batch, work] { work(*batch); });
+    }
+
+    // The caller only waits for runs that already started on other threads, so that a worker of the pool calling this
+    // never waits on tasks queued behind itself.
+    work(*batch);
+    batch->Done.wait();
+
+    for (const auto& error : batch->Errors)
+    {
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+    return std::move(batch->Results);
+}
+
+std::pair<std::size_t, std::size_t> GraphTemplate::FindSlot(const UUID& id, const IndexableName& key,
+                                                            bool input) const
+{
+    auto found = _node_steps.find(id);
+    if (found == _node_steps.end())
+    {
+        throw std::invalid_argument("node " + std::string(id) + " is not in graph template " + _graph->GetName());
+    }
+
+    const auto& step  = _steps[found->second];
+    const auto& slots = input ? step.Inputs : step.Outputs;
+
+    auto slot = std::find_if(slots.begin(), slots.end(), [&](const auto& s) { return s.first == key; });
+    if (slot == slots.end())
+    {
+        throw std::out_of_range("node " + step.Prototype->GetName() + " has no " + (input ? "input" : "output") +
+                                " port " + std::string{std::string_view(key)});
+    }
+
+    return {found->second, slot->second};
+}
+
+GraphInstance::GraphInstance(std::shared_ptr<const GraphTemplate> graph_template)
+    : _template{std::move(graph_template)}, _slots{_template->_defaults}, _dirty(_template->_steps.size(), true)
+{
+}
+
+void GraphInstance::SetInputData(const UUID& id, const IndexableName& key, SharedNodeData data)
+{
+    const auto [step, slot] = _template->FindSlot(id, key, true);
+
+    std::lock_guard _(_mutex);
+    _slots[slot] = std::move(data);
+    _dirty[step] = true;
+}
+
+SharedNodeData GraphInstance::GetOutputData(const UUID& id, const IndexableName& key) const
+{
+    const auto [_, slot] = _template->FindSlot(id, key, false);
+
+    std::lock_guard lock(_mutex);
+    return _slots[slot];
+}
+
+std::size_t GraphInstance::Run()
+{
+    std::lock_guard _(_mutex);
+
+    const auto& factory = _template->GetEnv()->GetFactory();
+    const auto& steps   = _template->_steps;
+
+    std::size_t computed = 0;
+    std::vector<std::uint64_t> versions;
+    std::vector<std::size_t> emitted;
+
+    for (std::size_t i = 0; i < steps.size(); ++i)
+    {
+        if (!_dirty[i])
+        {
+            continue;
+        }
+
+        _dirty[i] = false;
+        ++computed;
+
+        const auto& [prototype, inputs, outputs] = steps[i];
+
+        emitted.clear();
+        {
+            std::lock_guard lock(*prototype);
+
+            // Swap the data of this instance into the ports of the prototype.
+            for (const auto& [key, slot] : inputs)
+            {
+                prototype->GetInputPort(key)->SetData(_slots[slot], true);
+            }
+
+            versions.clear();
+            for (const auto& [key, slot] : outputs)
+            {
+                const auto& port = prototype->GetOutputPort(key);
+                versions.push_back(port->GetVersion());
+                port->SetData(_slots[slot], true);
+            }
+
+            prototype->InvokeCompute();
+
+            for (std::size_t j = 0; j < outputs.size(); ++j)
+            {
+                const auto& [key, slot] = outputs[j];
+                const auto& port        = prototype->GetOutputPort(key);
+
+                _slots[slot] = port->GetData();
+                if (port->GetVersion() != versions[j])
+                {
+                    emitted.push_back(slot);
+                }
+            }
+        }
+
+        for (const auto slot : emitted)
+        {
+            for (const auto& edge : _template->_edges[slot])
+            {
+                _slots[edge.Slot] = _slots[slot] ? factory->Convert(_slots[slot], edge.Type) : nullptr;
+                _dirty[edge.Node] = true;
+            }
+        }
+    }
+
+    return computed;
+}
+
+void GraphInstance::Schedule(Priority priority)
+{
+    _template->GetEnv()->AddPriorityTask(MakePriority(priority), [instance = shared_from_this()] { instance->Run(); });
+}
+
+FLOW_NAMESPACE_END
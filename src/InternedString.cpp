@@ -0,0 +1,64 @@
+// Copyright (c) 2024, Cisco Systems, Inc.
+// All rights reserved.
+
+#include "flow/core/InternedString.hpp"
+
+#include <functional>
+#include <mutex>
+#include <unordered_set>
+
+FLOW_NAMESPACE_BEGIN
+
+namespace
+{
+struct StringHash
+{
+    using is_transparent = void;
+
+    std::size_t operator()(std::string_view str) const noexcept { return std::hash<std::string_view>{}(str); }
+};
+
+struct StringPool
+{
+    std::mutex Mutex;
+
+    // Elements of an unordered_set are never moved, so pointers to them stay valid across rehashes.
+    std::unordered_set<std::string, StringHash, std::equal_to<>> Strings;
+};
+
+// Function statics, since strings can be interned during the static initialization of other translation units.
+const std::string& GetEmptyString() noexcept
+{
+    static const std::string empty;
+    return empty;
+}
+
+StringPool& GetStringPool()
+{
+    static StringPool pool;
+    return pool;
+}
+} // namespace
+
+InternedString::InternedString() noexcept : _str{&GetEmptyString()} {}
+
+InternedString::InternedString(std::string_view str) : _str{&GetEmptyString()}
+{
+    if (str.empty())
+    {
+        return;
+    }
+
+    auto& pool = GetStringPool();
+
+    std::lock_guard _(pool.Mutex);
+    if (auto found = pool.Strings.find(str); found != pool.Strings.end())
+    {
+        _str = &*found;
+        return;
+    }
+
+    _str = &*pool.Strings.emplace(str).first;
+}
+
+FLOW_NAMESPACE_END
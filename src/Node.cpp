@@ -3,10 +3,12 @@
 
 #include "flow/core/Node.hpp"
 
+#include "flow/core/Column.hpp"
 #include "flow/core/Env.hpp"
 
 #include <nlohmann/json.hpp>
 
+#include <algorithm>
 #include <memory>
 #include <stdarg.h>
 #include <utility>
@@ -14,6 +16,12 @@
 
 FLOW_NAMESPACE_BEGIN
 
+namespace
+{
+/// Nodes whose mutex is held by the calling thread, in the order they were locked.
+thread_local std::vector<const Node*> locked_nodes;
+} // namespace
+
 Node::Node(const UUID& uuid, std::string_view class_name, std::string_view name, std::shared_ptr<Env> env)
     : _id{uuid}, _class_name{class_name}, _name{name}, _env{std::move(env)}
 {
@@ -22,7 +30,43 @@ Node::Node(const UUID& uuid, std::string_view class_name, std::string_view name,
 void Node::InvokeCompute() noexcept
 try
 {
-    Compute();
+    _dirty.store(false, std::memory_order_release);
+
+    const auto compute = [this] {
+        if (SupportsBatch() && HasBatchInput())
+        {
+            ComputeBatch();
+        }
+        else
+        {
+            Compute();
+        }
+    };
+
+    if (_inline_policy != InlinePolicy::Auto)
+    {
+        compute();
+    }
+    else
+    {
+        const auto start = std::chrono::steady_clock::now();
+        compute();
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        const auto sample  = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+
+        // Smooth the measurements with a weight of 1/8 for the new sample.
+        const std::int64_t previous = _compute_time.load(std::memory_order_relaxed);
+        _compute_time.store(previous < 0 ? sample : previous + (sample - previous) / 8, std::memory_order_relaxed);
+    }
+
+    for (const auto& [_, port] : _input_ports)
+    {
+        if (port->GetRetention() != RetentionPolicy::KeepLast)
+        {
+            port->Release(_env->GetSettings().SpillDirectory);
+        }
+    }
+
     OnCompute.Broadcast();
 }
 catch (const std::exception& e)
@@ -46,11 +90,68 @@ catch (...)
     OnError.Broadcast(std::exception());
 }
 
+void Node::lock()
+{
+    _mutex.lock();
+    locked_nodes.push_back(this);
+}
+
+bool Node::try_lock()
+{
+    if (!_mutex.try_lock())
+    {
+        return false;
+    }
+
+    locked_nodes.push_back(this);
+    return true;
+}
+
+void Node::unlock()
+{
+    if (auto found = std::find(locked_nodes.rbegin(), locked_nodes.rend(), this); found != locked_nodes.rend())
+    {
+        locked_nodes.erase(std::next(found).base());
+    }
+
+    _mutex.unlock();
+}
+
+bool Node::IsLockedByCurrentThread() const noexcept
+{
+    return std::find(locked_nodes.begin(), locked_nodes.end(), this) != locked_nodes.end();
+}
+
+bool Node::HasBatchInput() const
+{
+    return std::any_of(_input_ports.begin(), _input_ports.end(), [](const auto& entry) {
+        return std::dynamic_pointer_cast<const IBatchData>(entry.second->GetData()) != nullptr;
+    });
+}
+
+std::optional<std::chrono::nanoseconds> Node::GetComputeTime() const noexcept
+{
+    const auto time = _compute_time.load(std::memory_order_relaxed);
+    return time < 0 ? std::nullopt : std::make_optional(std::chrono::nanoseconds(time));
+}
+
+std::stop_token Node::GetStopToken() noexcept
+{
+    const auto& context = RunContext::Current();
+    return context ? context->StopToken() : std::stop_token{};
+}
+
+bool Node::StopRequested() noexcept
+{
+    const auto& context = RunContext::Current();
+    return context && context->IsCancelled();
+}
+
 json Node::Save() const
 {
     return {
         {"id", std::string(_id)},
-        {"class", _class_name},
+        {"class", _class_name.Get()},
         {"name", _name},
         {"inputs", SaveInputs()},
     };
@@ -79,14 +180,17 @@ void Node::RestoreInputs(const json&) {}
 
 void Node::AddInput(std::string_view key, const std::string& caption, std::string_view type, SharedNodeData data)
 {
-    _input_ports.emplace(key, std::make_shared<Port>(key, caption, type, std::move(data),
-                                                     type.at(type.length() - 1) == '&', _input_ports.size()));
+    // Interning the key keeps the name referenced by the IndexableName alive, and shared by all nodes of the class.
+    const IndexableName name{std::string_view{InternedString{key}}};
+    _input_ports.emplace(name, std::make_shared<Port>(name, caption, type, std::move(data),
+                                                      type.at(type.length() - 1) == '&', _input_ports.size()));
 }
 
 void Node::AddOutput(std::string_view key, const std::string& caption, std::string_view type, SharedNodeData data)
 {
-    _output_ports.emplace(key, std::make_shared<Port>(key, caption, type, std::move(data),
-                                                      type.at(type.length() - 1) == '&', _output_ports.size()));
+    const IndexableName name{std::string_view{InternedString{key}}};
+    _output_ports.emplace(name, std::make_shared<Port>(name, caption, type, std::move(data),
+                                                       type.at(type.length() - 1) == '&', _output_ports.size()));
 }
 
 const SharedPort& Node::GetInputPort(const IndexableName& key) const { return _input_ports.at(key); }
@@ -95,11 +199,15 @@ const SharedPort& Node::GetOutputPort(const IndexableName& key) const { return _
 
 const SharedNodeData& Node::GetInputData(const IndexableName& key) const { return _input_ports.at(key)->GetData(); }
 
-const SharedNodeData& Node::GetOutputData(const IndexableName& key) const { return _output_ports.at(key)->GetData(); }
+const SharedNodeData& Node::GetOutputData(const IndexableName& key) const
+{
+    return _output_ports.at(key)->GetData();
+}
 
 void Node::SetInputData(const IndexableName& key, SharedNodeData data, bool compute)
 {
     _input_ports.at(key)->SetData(data);
+    _dirty.store(true, std::memory_order_release);
 
     OnSetInput.Broadcast(key, data);
 
@@ -111,20 +219,51 @@ void Node::SetInputData(const IndexableName& key, SharedNodeData data, bool comp
 
 void Node::SetOutputData(const IndexableName& key, SharedNodeData data, bool emit)
 {
-    _output_ports.at(key)->SetData(data, true);
+    const auto& port     = _output_ports.at(key);
+    const bool unchanged = emit && port->IsUnchanged(data);
+
+    port->SetData(data, true);
 
     OnSetOutput.Broadcast(key, data);
 
-    if (emit)
+    if (emit && !unchanged)
     {
         EmitUpdate(key, data);
     }
 }
 
+bool Node::GetChangeDetection(const IndexableName& key) const { return _output_ports.at(key)->GetChangeDetection(); }
+
+void Node::SetChangeDetection(const IndexableName& key, bool enabled)
+{
+    const auto& port = _output_ports.at(key);
+    if (enabled && !port->GetEquality())
+    {
+        auto equality = _env->GetFactory()->GetEquality(port->GetType());
+        if (!equality)
+        {
+            throw std::invalid_argument("no comparison for type " + std::string{port->GetType()} + " of output port " +
+                                        std::string{port->GetVarName()});
+        }
+
+        port->SetEquality(std::move(equality));
+    }
+
+    port->SetChangeDetection(enabled);
+}
+
 void Node::EmitUpdate(const IndexableName& key, const SharedNodeData& data)
 {
+    const auto& port = _output_ports.at(key);
+    port->BumpVersion();
     _propagate_output_update(ID(), key, data);
     OnEmitOutput.Broadcast(ID(), key, data);
+
+    // The connections hold their own references, so the port can release its data once it was handed to them.
+    if (port->GetRetention() != RetentionPolicy::KeepLast)
+    {
+        port->Release(_env->GetSettings().SpillDirectory);
+    }
 }
 
 FLOW_NAMESPACE_END
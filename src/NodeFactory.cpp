@@ -60,6 +60,17 @@ bool NodeFactory::IsConvertible(std::string_view from_type, std::string_view to_
     return _conversion_registry.IsConvertible(from_type, to_type);
 }
 
+TypeRegistry::EqualityFunc NodeFactory::GetEquality(std::string_view type) const
+{
+    auto equality = _conversion_registry.GetEquality(type);
+    return equality ? *equality : nullptr;
+}
+
+const TypeRegistry::HashFunc* NodeFactory::GetHash(std::string_view type) const
+{
+    return _conversion_registry.GetHash(type);
+}
+
 Category::Category(const std::string& name) : _category_name{name} {}
 
 Category::Category(const Category& parent, const std::string& name)
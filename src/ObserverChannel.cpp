@@ -0,0 +1,146 @@
+// Copyright (c) 2024, Cisco Systems, Inc.
+// All rights reserved.
+
+#include "flow/core/ObserverChannel.hpp"
+
+#include <algorithm>
+#include <string>
+
+FLOW_NAMESPACE_BEGIN
+
+ObserverChannel::ObserverChannel(std::chrono::milliseconds interval) : _interval{interval}
+{
+    _thread = std::jthread([this](std::stop_token token) { Service(std::move(token)); });
+}
+
+ObserverChannel::~ObserverChannel()
+{
+    _thread.request_stop();
+    if (_thread.joinable())
+    {
+        _thread.join();
+    }
+
+    for (const auto& observation : _observations)
+    {
+        Unbind(observation);
+    }
+}
+
+void ObserverChannel::Observe(const SharedNode& node, const IndexableName& key)
+{
+    // Use the key of the port, whose name outlives the given key.
+    const auto& port_key = node->GetOutputPort(key)->GetKey();
+
+    std::lock_guard _(_mutex);
+
+    const auto observed = [&](const Observation& observation) {
+        return observation.NodeID == node->ID() && observation.PortKey == port_key;
+    };
+    if (std::any_of(_observations.begin(), _observations.end(), observed))
+    {
+        return;
+    }
+
+    auto slot = std::make_shared<Slot>();
+    auto name = std::make_unique<const std::string>(std::string(_id) + "/" + std::string(node->ID()) + "/" +
+                                                    std::string{port_key.name()});
+
+    node->OnSetOutput.Bind(IndexableName{std::string_view{*name}},
+                           [slot, port_key](const IndexableName& key, const SharedNodeData& data) {
+                               if (key == port_key)
+                               {
+                                   slot->Data.store(data);
+                                   slot->Changed.store(true, std::memory_order_release);
+                               }
+                           });
+
+    _observations.push_back({node, node->ID(), port_key, std::move(name), std::move(slot)});
+}
+
+bool ObserverChannel::Unobserve(const UUID& id, const IndexableName& key)
+{
+    std::lock_guard _(_mutex);
+
+    auto found = std::find_if(_observations.begin(), _observations.end(), [&](const Observation& observation) {
+        return observation.NodeID == id && observation.PortKey == key;
+    });
+    if (found == _observations.end())
+    {
+        return false;
+    }
+
+    Unbind(*found);
+    _observations.erase(found);
+    return true;
+}
+
+std::chrono::milliseconds ObserverChannel::GetInterval() const
+{
+    std::lock_guard _(_mutex);
+    return _interval;
+}
+
+void ObserverChannel::SetInterval(std::chrono::milliseconds interval)
+{
+    {
+        std::lock_guard _(_mutex);
+        _interval = interval;
+    }
+
+    _cv.notify_all();
+}
+
+std::size_t ObserverChannel::Flush()
+{
+    std::lock_guard delivery(_delivery_mutex);
+
+    std::vector<ObservedUpdate> updates;
+    {
+        std::lock_guard _(_mutex);
+        for (const auto& observation : _observations)
+        {
+            if (observation.Latest->Changed.exchange(false, std::memory_order_acq_rel))
+            {
+                updates.push_back({observation.NodeID, observation.PortKey, observation.Latest->Data.load()});
+            }
+        }
+    }
+
+    if (!updates.empty())
+    {
+        OnUpdates.Broadcast(updates);
+    }
+
+    return updates.size();
+}
+
+void ObserverChannel::Unbind(const Observation& observation)
+{
+    if (auto node = observation.Owner.lock())
+    {
+        node->OnSetOutput.Unbind(IndexableName{std::string_view{*observation.HookName}});
+    }
+}
+
+void ObserverChannel::Service(std::stop_token token)
+{
+    while (!token.stop_requested())
+    {
+        {
+            std::unique_lock lock(_mutex);
+            const auto deadline = std::chrono::steady_clock::now() + _interval;
+
+            // Waits out the full interval, or until it is changed.
+            const auto interval = _interval;
+            _cv.wait_until(lock, token, deadline, [&] { return _interval != interval; });
+        }
+
+        if (!token.stop_requested())
+        {
+            Flush();
+        }
+    }
+}
+
+FLOW_NAMESPACE_END
@@ -3,14 +3,23 @@
 
 #include "flow/core/Port.hpp"
 
+#include "flow/core/UUID.hpp"
+
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
 FLOW_NAMESPACE_BEGIN
 
 Port::Port(const IndexableName& key, const std::string& caption, std::string_view type, SharedNodeData data,
            bool required, std::size_t index)
-    : _data{std::move(data)}, _key{key}, _caption{caption}, _type{type}, _required{required}, _index{index}
+    : _data{std::move(data)}, _key{key}, _caption{caption}, _type{type}, _index{index}, _required{required}
 {
 }
 
+Port::~Port() { DiscardSpill(); }
+
 bool Port::Connect() noexcept
 {
     if (IsConnected()) return false;
@@ -34,7 +43,10 @@ void Port::SetData(SharedNodeData data, bool output)
         return;
     }
 
-    if (!_data || !data || output)
+    DiscardSpill();
+
+    // Data of another type, such as a batch of records, cannot be copied into the current data.
+    if (!_data || !data || output || _data->Type() != data->Type())
     {
         _data = std::move(data);
     }
@@ -49,6 +61,148 @@ void Port::SetData(SharedNodeData data, bool output)
     }
 }
 
-void Port::SetCaption(std::string new_caption) { _caption = std::move(new_caption); }
+void Port::Promote()
+{
+    if (!_data || !_data->IsInArena())
+    {
+        return;
+    }
+
+    if (auto copy = _data->Clone())
+    {
+        _data = std::move(copy);
+    }
+}
+
+bool Port::Release(const std::filesystem::path& spill_directory)
+{
+    if (!_data || IsSpilled())
+    {
+        return false;
+    }
+
+    switch (_retention)
+    {
+    case RetentionPolicy::KeepLast:
+        return false;
+
+    case RetentionPolicy::ReleaseAfterConsume:
+        if (IsRequired())
+        {
+            return false;
+        }
+
+        _data = nullptr;
+        return true;
+
+    case RetentionPolicy::Spill:
+        break;
+    }
+
+    auto empty = _data->MakeEmpty();
+    if (!empty)
+    {
+        return false;
+    }
+
+    auto file = std::make_unique<std::filesystem::path>(
+        spill_directory.empty() ? std::filesystem::temp_directory_path() : spill_directory);
+    *file /= "flow-" + std::string(UUID{}) + ".spill";
+
+    std::lock_guard _(_spill_mutex);
+    std::ofstream stream(*file, std::ios::binary);
+    if (!stream || !_data->WriteBytes(stream) || !stream.flush())
+    {
+        stream.close();
+        std::error_code error;
+        std::filesystem::remove(*file, error);
+        return false;
+    }
+
+    _data       = std::move(empty);
+    _spill_file = std::move(file);
+    _spilled.store(true, std::memory_order_release);
+    return true;
+}
+
+void Port::Restore() const
+{
+    std::lock_guard _(_spill_mutex);
+    if (!_spill_file)
+    {
+        return;
+    }
+
+    std::ifstream stream(*_spill_file, std::ios::binary);
+    if (!stream || !_data->ReadBytes(stream))
+    {
+        throw std::runtime_error("failed to restore the spilled data of port " + std::string{GetVarName()} +
+                                 " from " + _spill_file->string());
+    }
+
+    stream.close();
+    std::error_code error;
+    std::filesystem::remove(*_spill_file, error);
+    _spill_file.reset();
+    _spilled.store(false, std::memory_order_release);
+}
+
+void Port::DiscardSpill() const noexcept
+{
+    if (!IsSpilled())
+    {
+        return;
+    }
+
+    std::lock_guard _(_spill_mutex);
+    if (!_spill_file)
+    {
+        return;
+    }
+
+    std::error_code error;
+    std::filesystem::remove(*_spill_file, error);
+    _spill_file.reset();
+    _spilled.store(false, std::memory_order_release);
+}
+
+void Port::SetPendingData(SharedNodeData data) noexcept
+{
+    _pending_data.store(std::move(data));
+    _has_pending_data.store(true, std::memory_order_release);
+}
+
+bool Port::TakePendingData(SharedNodeData& data) noexcept
+{
+    if (!_has_pending_data.exchange(false, std::memory_order_acquire))
+    {
+        return false;
+    }
+
+    data = _pending_data.load();
+    return true;
+}
+
+bool Port::IsUnchanged(const SharedNodeData& data) const
+{
+    if (!_change_detection || !_equality || !data)
+    {
+        return false;
+    }
+
+    // Spilled data is read back first, since the empty value held in its place would compare as the stored value.
+    const auto& current = GetData();
+    if (!current || current == data || current->AsPointer() == data->AsPointer())
+    {
+        return false;
+    }
+
+    return _equality(current, data);
+}
+
+void Port::SetCaption(std::string new_caption)
+{
+    _custom_caption = std::make_unique<std::string>(std::move(new_caption));
+}
 
 FLOW_NAMESPACE_END
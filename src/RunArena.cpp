@@ -0,0 +1,103 @@
+// Copyright (c) 2024, Cisco Systems, Inc.
+// All rights reserved.
+
+#include "flow/core/RunArena.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <utility>
+
+FLOW_NAMESPACE_BEGIN
+
+namespace
+{
+/// Arena of the run being executed on the current thread.
+thread_local RunArena* current_arena = nullptr;
+
+/// Chunk the current thread allocates from, and the arena it belongs to.
+struct ThreadChunk
+{
+    std::uint64_t ArenaID = 0;
+    std::byte* Cursor     = nullptr;
+    std::byte* End        = nullptr;
+};
+
+/// Number of arenas a thread keeps a chunk of, so that a worker alternating between concurrent runs keeps its chunks.
+constexpr std::size_t cached_chunks = 4;
+
+/// Chunks of the current thread, and the entry replaced next when it allocates from an arena without a chunk.
+struct ThreadChunks
+{
+    std::array<ThreadChunk, cached_chunks> Chunks;
+    std::size_t Next = 0;
+};
+
+thread_local ThreadChunks thread_chunks;
+
+std::atomic<std::uint64_t> next_arena_id = 1;
+
+std::byte* AlignUp(std::byte* ptr, std::size_t alignment) noexcept
+{
+    const auto address = reinterpret_cast<std::uintptr_t>(ptr);
+    return ptr + ((alignment - address % alignment) % alignment);
+}
+} // namespace
+
+RunArena::RunArena(std::size_t chunk_size)
+    : _id{next_arena_id.fetch_add(1, std::memory_order_relaxed)}, _chunk_size{chunk_size}
+{
+}
+
+RunArena::~RunArena() = default;
+
+void* RunArena::Allocate(std::size_t size, std::size_t alignment)
+{
+    if (size + alignment > _chunk_size / 4)
+    {
+        return ::operator new(size, std::align_val_t{alignment});
+    }
+
+    auto& chunks = thread_chunks.Chunks;
+    auto found   = std::find_if(chunks.begin(), chunks.end(), [this](const auto& c) { return c.ArenaID == _id; });
+    auto& chunk  = found != chunks.end() ? *found : chunks[thread_chunks.Next++ % cached_chunks];
+    auto* ptr    = chunk.ArenaID == _id ? AlignUp(chunk.Cursor, alignment) : nullptr;
+    if (!ptr || ptr > chunk.End || static_cast<std::size_t>(chunk.End - ptr) < size)
+    {
+        // Left uninitialized, unlike make_unique, since the chunk is only ever written by the values constructed in it.
+        std::unique_ptr<std::byte[]> memory{new std::byte[_chunk_size]};
+        chunk = {_id, memory.get(), memory.get() + _chunk_size};
+        {
+            std::lock_guard _(_mutex);
+            _chunks.push_back(std::move(memory));
+        }
+
+        ptr = AlignUp(chunk.Cursor, alignment);
+    }
+
+    _allocated.fetch_add(static_cast<std::size_t>(ptr + size - chunk.Cursor), std::memory_order_relaxed);
+    chunk.Cursor = ptr + size;
+    return ptr;
+}
+
+void RunArena::Deallocate(void* ptr, std::size_t size, std::size_t alignment) noexcept
+{
+    if (size + alignment > _chunk_size / 4)
+    {
+        ::operator delete(ptr, std::align_val_t{alignment});
+    }
+}
+
+std::size_t RunArena::ChunkCount() const
+{
+    std::lock_guard _(_mutex);
+    return _chunks.size();
+}
+
+RunArena* RunArena::Current() noexcept { return current_arena; }
+
+RunArena::Scope::Scope(RunArena* arena) noexcept : _previous{std::exchange(current_arena, arena)} {}
+
+RunArena::Scope::~Scope() { current_arena = _previous; }
+
+FLOW_NAMESPACE_END
@@ -0,0 +1,48 @@
+// Copyright (c) 2024, Cisco Systems, Inc.
+// All rights reserved.
+
+#include "flow/core/RunContext.hpp"
+
+#include <utility>
+
+FLOW_NAMESPACE_BEGIN
+
+namespace
+{
+/// Context of the graph run being executed on the current thread.
+thread_local SharedRunContext current_context;
+} // namespace
+
+RunContext::RunContext(std::uint64_t sequence, std::stop_token token, std::optional<clock::time_point> deadline,
+                       std::shared_ptr<RunArena> arena, std::function<void()> on_complete)
+    : _sequence{sequence}, _token{std::move(token)}, _deadline{deadline}, _arena{std::move(arena)},
+      _on_complete{std::move(on_complete)}
+{
+}
+
+RunContext::~RunContext()
+{
+    // The arena is released first, so that the callback can tell if any data still holds on to it.
+    _arena.reset();
+    if (_on_complete)
+    {
+        _on_complete();
+    }
+}
+
+bool RunContext::IsCancelled() const noexcept
+{
+    return _token.stop_requested() || (_deadline && clock::now() >= *_deadline);
+}
+
+const SharedRunContext& RunContext::Current() noexcept { return current_context; }
+
+RunContext::Scope::Scope(SharedRunContext context) noexcept
+    : _previous{std::exchange(current_context, std::move(context))},
+      _arena_scope{current_context ? current_context->Arena().get() : nullptr}
+{
+}
+
+RunContext::Scope::~Scope() { current_context = std::move(_previous); }
+
+FLOW_NAMESPACE_END
@@ -0,0 +1,175 @@
+// Copyright (c) 2024, Cisco Systems, Inc.
+// All rights reserved.
+
+#include "flow/core/SpinPool.hpp"
+
+#if defined(FLOW_X86_64) || defined(FLOW_X86)
+#include <immintrin.h>
+#endif
+
+FLOW_NAMESPACE_BEGIN
+
+namespace
+{
+/// Tells the CPU that this is a spin loop, to save power and free resources for a sibling hyperthread.
+inline void CpuRelax() noexcept
+{
+#if defined(FLOW_X86_64) || defined(FLOW_X86)
+    _mm_pause();
+#elif defined(FLOW_ARM) && defined(_MSC_VER)
+    __yield();
+#elif defined(FLOW_ARM)
+    asm volatile("yield");
+#endif
+}
+
+/// Number of pause hints between checks of the clock while spinning.
+constexpr std::size_t spins_per_clock_check = 64;
+} // namespace
+
+SpinPool::SpinPool(std::size_t threads, std::chrono::nanoseconds spin_budget, std::function<void(std::size_t)> init,
+                   std::function<void(std::exception_ptr)> on_error)
+    : _spin_budget{spin_budget}, _on_error{std::move(on_error)}
+{
+    _threads.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i)
+    {
+        _threads.emplace_back([this, i, init] { Work(i, init); });
+    }
+}
+
+SpinPool::~SpinPool()
+{
+    Wait();
+
+    _stop = true;
+    ++_wakeups;
+    _wakeups.notify_all();
+
+    for (auto& thread : _threads)
+    {
+        thread.join();
+    }
+}
+
+void SpinPool::Push(std::function<void()> task)
+{
+    ++_pending;
+    {
+        std::lock_guard lock(_mutex);
+        _tasks.push_back(std::move(task));
+    }
+    ++_queued;
+
+    if (_parked.load() != 0)
+    {
+        ++_wakeups;
+        _wakeups.notify_one();
+    }
+}
+
+void SpinPool::Wait()
+{
+    for (auto pending = _pending.load(); pending != 0; pending = _pending.load())
+    {
+        _pending.wait(pending);
+    }
+}
+
+bool SpinPool::TryPop(std::function<void()>& task)
+{
+    if (_queued.load(std::memory_order_acquire) == 0)
+    {
+        return false;
+    }
+
+    std::lock_guard lock(_mutex);
+    if (_tasks.empty())
+    {
+        return false;
+    }
+
+    task = std::move(_tasks.front());
+    _tasks.pop_front();
+    --_queued;
+    return true;
+}
+
+bool SpinPool::Spin() const noexcept
+{
+    const auto deadline = _spin_budget == unlimited_spin ? std::chrono::steady_clock::time_point::max()
+                                                         : std::chrono::steady_clock::now() + _spin_budget;
+    while (true)
+    {
+        for (std::size_t i = 0; i < spins_per_clock_check; ++i)
+        {
+            if (_queued.load(std::memory_order_relaxed) != 0 || _stop.load(std::memory_order_relaxed))
+            {
+                return true;
+            }
+
+            CpuRelax();
+        }
+
+        if (std::chrono::steady_clock::now() >= deadline)
+        {
+            return false;
+        }
+    }
+}
+
+void SpinPool::Work(std::size_t index, const std::function<void(std::size_t)>& init)
+{
+    if (init)
+    {
+        init(index);
+    }
+
+    std::function<void()> task;
+    while (true)
+    {
+        if (TryPop(task))
+        {
+            try
+            {
+                task();
+            }
+            catch (...)
+            {
+                if (_on_error)
+                {
+                    _on_error(std::current_exception());
+                }
+            }
+            task = nullptr;
+
+            if (--_pending == 0)
+            {
+                _pending.notify_all();
+            }
+            continue;
+        }
+
+        if (_stop)
+        {
+            return;
+        }
+
+        if (Spin())
+        {
+            continue;
+        }
+
+        // Register as parked before checking for tasks again, so that a concurrent Push either sees this worker as
+        // parked and bumps the wakeup counter, or its task is seen here.
+        const auto wakeups = _wakeups.load();
+        ++_parked;
+        if (_queued.load() == 0 && !_stop)
+        {
+            _wakeups.wait(wakeups);
+        }
+        --_parked;
+    }
+}
+
+FLOW_NAMESPACE_END
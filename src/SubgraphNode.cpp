@@ -0,0 +1,100 @@
+// Copyright (c) 2024, Cisco Systems, Inc.
+// All rights reserved.
+
+#include "flow/core/SubgraphNode.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+FLOW_NAMESPACE_BEGIN
+
+SubgraphNode::SubgraphNode(const UUID& uuid, const std::string& name, std::shared_ptr<Env> env,
+                           std::shared_ptr<Graph> graph)
+    : Node(uuid, TypeName_v<SubgraphNode>, name, std::move(env)), _graph{std::move(graph)}
+{
+    if (!_graph)
+    {
+        throw std::invalid_argument("subgraph node " + name + " requires a graph");
+    }
+}
+
+void SubgraphNode::ExposeInput(std::string_view key, const UUID& node, const IndexableName& port)
+{
+    auto inner = _graph->GetNode(node);
+    if (!inner)
+    {
+        throw std::invalid_argument("node " + std::string(node) + " is not in graph " + _graph->GetName());
+    }
+
+    const auto type = inner->GetInputPort(port)->GetType();
+
+    const IndexableName name{key};
+    if (const auto& inputs = GetInputPorts(); !inputs.contains(name))
+    {
+        AddInput(key, std::string{key}, type, nullptr);
+    }
+    else if (inputs.at(name)->GetType() != type)
+    {
+        throw std::invalid_argument("input " + std::string{key} + " is already exposed with type " +
+                                    std::string{inputs.at(name)->GetType()});
+    }
+
+    _exposed_inputs[name].push_back({node, port});
+}
+
+void SubgraphNode::ExposeOutput(std::string_view key, const UUID& node, const IndexableName& port)
+{
+    auto inner = _graph->GetNode(node);
+    if (!inner)
+    {
+        throw std::invalid_argument("node " + std::string(node) + " is not in graph " + _graph->GetName());
+    }
+
+    const IndexableName name{key};
+    if (_exposed_outputs.contains(name))
+    {
+        throw std::invalid_argument("output " + std::string{key} + " is already exposed");
+    }
+
+    AddOutput(key, std::string{key}, inner->GetOutputPort(port)->GetType(), nullptr);
+    _exposed_outputs.emplace(name, ExposedPort{node, port});
+}
+
+void SubgraphNode::Compute()
+{
+    for (const auto& [key, targets] : _exposed_inputs)
+    {
+        const auto& data = GetInputData(key);
+        if (!data)
+        {
+            continue;
+        }
+
+        for (const auto& target : targets)
+        {
+            _graph->SetInputData(target.NodeID, target.PortKey, data);
+        }
+    }
+
+    // Recompute runs the nodes downstream of the inputs, Evaluate the ones that feed the outputs but were never run.
+    _graph->Recompute();
+
+    std::vector<IndexableName> keys;
+    std::vector<std::pair<UUID, IndexableName>> outputs;
+    for (const auto& [key, source] : _exposed_outputs)
+    {
+        keys.push_back(key);
+        outputs.emplace_back(source.NodeID, source.PortKey);
+    }
+
+    const auto results = _graph->Evaluate(outputs);
+    for (std::size_t i = 0; i < keys.size(); ++i)
+    {
+        if (results[i])
+        {
+            SetOutputData(keys[i], results[i]);
+        }
+    }
+}
+
+FLOW_NAMESPACE_END
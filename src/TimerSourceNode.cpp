@@ -0,0 +1,116 @@
+// Copyright (c) 2024, Cisco Systems, Inc.
+// All rights reserved.
+
+#include "flow/core/TimerSourceNode.hpp"
+
+#include "flow/core/NodeData.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <mutex>
+
+FLOW_NAMESPACE_BEGIN
+
+namespace
+{
+constexpr std::chrono::milliseconds default_interval{1000};
+} // namespace
+
+struct TimerSourceNode::State
+{
+    std::mutex Mutex;
+    TimerSourceNode* Node;
+};
+
+TimerSourceNode::TimerSourceNode(const UUID& uuid, const std::string& name, std::shared_ptr<Env> env)
+    : Node(uuid, TypeName_v<TimerSourceNode>, name, std::move(env)),
+      _state{std::make_shared<State>()}
+{
+    _state->Node = this;
+    AddInput<std::chrono::milliseconds>("interval", "Interval", MakeNodeData(default_interval));
+    AddOutput<std::uint64_t>("tick", "Tick");
+}
+
+TimerSourceNode::~TimerSourceNode()
+{
+    Stop();
+
+    std::lock_guard lock(_state->Mutex);
+    _state->Node = nullptr;
+}
+
+void TimerSourceNode::Start()
+{
+    std::lock_guard lock(*this);
+    Disarm();
+
+    _ticks = 0;
+    Arm(GetInterval());
+}
+
+void TimerSourceNode::Stop()
+{
+    std::lock_guard lock(*this);
+    Disarm();
+}
+
+void TimerSourceNode::Compute()
+{
+    if (const auto interval = GetInterval(); _timer && interval != _interval)
+    {
+        Disarm();
+        Arm(interval);
+    }
+}
+
+json TimerSourceNode::SaveInputs() const { return {{"interval", GetInterval().count()}}; }
+
+void TimerSourceNode::RestoreInputs(const json& j)
+{
+    if (j.contains("interval"))
+    {
+        SetInputData("interval", MakeNodeData(std::chrono::milliseconds(j["interval"].get<std::int64_t>())), false);
+    }
+}
+
+std::chrono::milliseconds TimerSourceNode::GetInterval() const
+{
+    if (auto interval = GetInputData<std::chrono::milliseconds>("interval"))
+    {
+        return interval->Get();
+    }
+
+    return default_interval;
+}
+
+void TimerSourceNode::Arm(std::chrono::milliseconds interval)
+{
+    _interval = interval;
+    _timer    = GetEnv()->AddPeriodicTimer(interval, [state = _state] {
+        std::lock_guard lock(state->Mutex);
+        if (state->Node != nullptr)
+        {
+            state->Node->Tick();
+        }
+    });
+}
+
+void TimerSourceNode::Disarm()
+{
+    if (_timer)
+    {
+        GetEnv()->CancelTimer(*_timer);
+        _timer.reset();
+    }
+}
+
+void TimerSourceNode::Tick()
+{
+    std::lock_guard lock(*this);
+    if (_timer)
+    {
+        SetOutputData("tick", MakeNodeData<std::uint64_t>(++_ticks));
+    }
+}
+
+FLOW_NAMESPACE_END
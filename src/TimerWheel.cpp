@@ -0,0 +1,298 @@
+// Copyright (c) 2024, Cisco Systems, Inc.
+// All rights reserved.
+
+#include "flow/core/TimerWheel.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+FLOW_NAMESPACE_BEGIN
+
+namespace
+{
+/// Remaining wait below which the service thread yields instead of sleeping, since sleeps overshoot by about as much.
+constexpr std::uint64_t spin_threshold = 50;
+
+constexpr std::uint64_t LowMask(std::size_t bits) noexcept
+{
+    return bits >= 64 ? std::numeric_limits<std::uint64_t>::max() : (std::uint64_t{1} << bits) - 1;
+}
+} // namespace
+
+TimerWheel::TimerWheel()
+{
+    for (auto& level : _slots)
+    {
+        level.fill(npos);
+    }
+
+    _thread = std::jthread([this](std::stop_token token) { Service(std::move(token)); });
+}
+
+TimerWheel::~TimerWheel()
+{
+    _thread.request_stop();
+    if (_thread.joinable())
+    {
+        _thread.join();
+    }
+}
+
+TimerWheel::TimerID TimerWheel::Add(std::chrono::microseconds delay, Callback callback,
+                                    std::chrono::microseconds period)
+{
+    const auto now = Now();
+
+    std::lock_guard lock(_mutex);
+
+    std::uint32_t index = 0;
+    if (!_free.empty())
+    {
+        index = _free.back();
+        _free.pop_back();
+    }
+    else
+    {
+        index = static_cast<std::uint32_t>(_entries.size());
+        _entries.emplace_back();
+    }
+
+    auto& entry    = _entries[index];
+    entry.Expiry   = std::max(now + static_cast<std::uint64_t>(std::max<std::int64_t>(delay.count(), 0)), _elapsed);
+    entry.Period   = static_cast<std::uint64_t>(std::max<std::int64_t>(period.count(), 0));
+    entry.Function = std::make_shared<const Callback>(std::move(callback));
+    entry.Armed    = true;
+    ++_armed;
+
+    Link(index);
+
+    if (entry.Expiry < _wake)
+    {
+        _wake = entry.Expiry;
+        _cv.notify_one();
+    }
+
+    return (static_cast<TimerID>(entry.Generation) << 32) | index;
+}
+
+bool TimerWheel::Cancel(TimerID id)
+{
+    const auto index      = static_cast<std::uint32_t>(id & 0xFFFFFFFF);
+    const auto generation = static_cast<std::uint32_t>(id >> 32);
+
+    std::lock_guard lock(_mutex);
+    if (index >= _entries.size() || _entries[index].Generation != generation || !_entries[index].Armed)
+    {
+        return false;
+    }
+
+    Unlink(index);
+    Release(index);
+    return true;
+}
+
+std::size_t TimerWheel::Size() const
+{
+    std::lock_guard lock(_mutex);
+    return _armed;
+}
+
+std::uint64_t TimerWheel::Now() const noexcept
+{
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - _start).count());
+}
+
+void TimerWheel::Link(std::uint32_t index)
+{
+    auto& entry = _entries[index];
+
+    const auto diff  = entry.Expiry ^ _elapsed;
+    const auto level = diff == 0 ? 0 : std::min<std::size_t>((std::bit_width(diff) - 1) / slot_bits, level_count - 1);
+    const auto slot  = static_cast<std::size_t>((entry.Expiry >> (level * slot_bits)) & (slot_count - 1));
+
+    entry.Level    = static_cast<std::uint8_t>(level);
+    entry.Slot     = static_cast<std::uint8_t>(slot);
+    entry.Previous = npos;
+    entry.Next     = _slots[level][slot];
+
+    if (entry.Next != npos)
+    {
+        _entries[entry.Next].Previous = index;
+    }
+
+    _slots[level][slot] = index;
+    _occupied[level] |= std::uint64_t{1} << slot;
+}
+
+void TimerWheel::Unlink(std::uint32_t index)
+{
+    auto& entry = _entries[index];
+
+    if (entry.Previous != npos)
+    {
+        _entries[entry.Previous].Next = entry.Next;
+    }
+    else
+    {
+        _slots[entry.Level][entry.Slot] = entry.Next;
+    }
+
+    if (entry.Next != npos)
+    {
+        _entries[entry.Next].Previous = entry.Previous;
+    }
+
+    if (_slots[entry.Level][entry.Slot] == npos)
+    {
+        _occupied[entry.Level] &= ~(std::uint64_t{1} << entry.Slot);
+    }
+
+    entry.Previous = entry.Next = npos;
+}
+
+void TimerWheel::Release(std::uint32_t index)
+{
+    auto& entry = _entries[index];
+    entry.Function.reset();
+    entry.Armed = false;
+    ++entry.Generation;
+    --_armed;
+
+    _free.push_back(index);
+}
+
+bool TimerWheel::NextDeadline(std::size_t& level, std::size_t& slot, std::uint64_t& deadline) const noexcept
+{
+    for (level = 0; level < level_count; ++level)
+    {
+        const auto occupied = _occupied[level];
+        if (occupied == 0)
+        {
+            continue;
+        }
+
+        const auto shift   = level * slot_bits;
+        const auto current = (_elapsed >> shift) & (slot_count - 1);
+        const auto ahead   = occupied & (~std::uint64_t{0} << current);
+
+        if (ahead == 0)
+        {
+            // Slots behind the current position can only hold timers that are already due.
+            slot     = static_cast<std::size_t>(std::countr_zero(occupied));
+            deadline = _elapsed;
+            return true;
+        }
+
+        slot     = static_cast<std::size_t>(std::countr_zero(ahead));
+        deadline = std::max((_elapsed & ~LowMask(shift + slot_bits)) | (std::uint64_t{slot} << shift), _elapsed);
+        return true;
+    }
+
+    return false;
+}
+
+void TimerWheel::Advance(std::uint64_t now, std::vector<std::shared_ptr<const Callback>>& due)
+{
+    std::size_t level      = 0;
+    std::size_t slot       = 0;
+    std::uint64_t deadline = 0;
+
+    while (NextDeadline(level, slot, deadline) && deadline <= now)
+    {
+        _elapsed = deadline;
+
+        auto index          = _slots[level][slot];
+        _slots[level][slot] = npos;
+        _occupied[level] &= ~(std::uint64_t{1} << slot);
+
+        while (index != npos)
+        {
+            auto& entry     = _entries[index];
+            const auto next = entry.Next;
+            entry.Previous = entry.Next = npos;
+
+            if (entry.Expiry > _elapsed)
+            {
+                // Cascade down to a finer level.
+                Link(index);
+            }
+            else if (entry.Period != 0)
+            {
+                due.push_back(entry.Function);
+
+                entry.Expiry += entry.Period;
+                if (entry.Expiry <= now)
+                {
+                    entry.Expiry += ((now - entry.Expiry) / entry.Period + 1) * entry.Period;
+                }
+
+                Link(index);
+            }
+            else
+            {
+                due.push_back(std::move(entry.Function));
+                Release(index);
+            }
+
+            index = next;
+        }
+    }
+
+    _elapsed = std::max(_elapsed, now);
+}
+
+void TimerWheel::Service(std::stop_token token)
+{
+    std::vector<std::shared_ptr<const Callback>> due;
+
+    std::unique_lock lock(_mutex);
+    while (!token.stop_requested())
+    {
+        Advance(Now(), due);
+
+        if (!due.empty())
+        {
+            lock.unlock();
+            for (const auto& callback : due)
+            {
+                (*callback)();
+            }
+            due.clear();
+            lock.lock();
+            continue;
+        }
+
+        std::size_t level      = 0;
+        std::size_t slot       = 0;
+        std::uint64_t deadline = 0;
+        if (!NextDeadline(level, slot, deadline))
+        {
+            _wake = std::numeric_limits<std::uint64_t>::max();
+            _cv.wait(lock, token, [&] { return _armed != 0; });
+            continue;
+        }
+
+        const auto now = Now();
+        if (deadline <= now)
+        {
+            continue;
+        }
+
+        if (deadline - now <= spin_threshold)
+        {
+            lock.unlock();
+            std::this_thread::yield();
+            lock.lock();
+            continue;
+        }
+
+        _wake = deadline;
+        _cv.wait_until(lock, token, _start + std::chrono::microseconds(deadline - spin_threshold),
+                       [&] { return _wake != deadline; });
+        _wake = std::numeric_limits<std::uint64_t>::max();
+    }
+}
+
+FLOW_NAMESPACE_END
@@ -0,0 +1,170 @@
+// Copyright (c) 2024, Cisco Systems, Inc.
+// All rights reserved.
+
+#include "flow/core/Topology.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+#ifdef FLOW_WINDOWS
+#include <windows.h>
+#else
+#include <pthread.h>
+#ifdef FLOW_LINUX
+#include <sched.h>
+#endif
+#endif
+
+FLOW_NAMESPACE_BEGIN
+
+namespace
+{
+#ifdef FLOW_LINUX
+const std::filesystem::path numa_node_root = "/sys/devices/system/node";
+
+/// Parses a kernel CPU list, such as "0-3,8-11".
+CpuSet ParseCpuList(std::string_view list)
+{
+    CpuSet cpus;
+    while (!list.empty())
+    {
+        const auto comma = list.find(',');
+        auto range       = list.substr(0, comma);
+        list             = comma == std::string_view::npos ? std::string_view{} : list.substr(comma + 1);
+
+        std::size_t first = 0;
+        auto [end, ec]    = std::from_chars(range.data(), range.data() + range.size(), first);
+        if (ec != std::errc{})
+        {
+            continue;
+        }
+
+        std::size_t last = first;
+        if (end != range.data() + range.size() && *end == '-')
+        {
+            std::from_chars(end + 1, range.data() + range.size(), last);
+        }
+
+        for (auto cpu = first; cpu <= last; ++cpu)
+        {
+            cpus.push_back(cpu);
+        }
+    }
+
+    return cpus;
+}
+#endif
+} // namespace
+
+std::size_t GetNumaNodeCount()
+{
+#ifdef FLOW_LINUX
+    std::error_code ec;
+    std::size_t count = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(numa_node_root, ec))
+    {
+        const auto name = entry.path().filename().string();
+        if (name.starts_with("node") && name.size() > 4 && std::isdigit(static_cast<unsigned char>(name[4])))
+        {
+            ++count;
+        }
+    }
+
+    return std::max<std::size_t>(count, 1);
+#elif defined(FLOW_WINDOWS)
+    ULONG highest = 0;
+    return GetNumaHighestNodeNumber(&highest) ? static_cast<std::size_t>(highest) + 1 : 1;
+#else
+    return 1;
+#endif
+}
+
+CpuSet GetNumaNodeCpus(std::size_t node)
+{
+#ifdef FLOW_LINUX
+    std::ifstream file(numa_node_root / ("node" + std::to_string(node)) / "cpulist");
+    std::string list;
+    if (!std::getline(file, list))
+    {
+        return {};
+    }
+
+    return ParseCpuList(list);
+#elif defined(FLOW_WINDOWS)
+    GROUP_AFFINITY affinity{};
+    if (!GetNumaNodeProcessorMaskEx(static_cast<USHORT>(node), &affinity))
+    {
+        return {};
+    }
+
+    CpuSet cpus;
+    for (std::size_t cpu = 0; cpu < sizeof(KAFFINITY) * 8; ++cpu)
+    {
+        if (affinity.Mask & (KAFFINITY{1} << cpu))
+        {
+            cpus.push_back(affinity.Group * sizeof(KAFFINITY) * 8 + cpu);
+        }
+    }
+
+    return cpus;
+#else
+    return {};
+#endif
+}
+
+bool SetCurrentThreadAffinity(std::span<const std::size_t> cpus)
+{
+    if (cpus.empty())
+    {
+        return false;
+    }
+
+#ifdef FLOW_LINUX
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (auto cpu : cpus)
+    {
+        if (cpu >= CPU_SETSIZE)
+        {
+            return false;
+        }
+
+        CPU_SET(cpu, &set);
+    }
+
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#elif defined(FLOW_WINDOWS)
+    DWORD_PTR mask = 0;
+    for (auto cpu : cpus)
+    {
+        if (cpu >= sizeof(DWORD_PTR) * 8)
+        {
+            return false;
+        }
+
+        mask |= DWORD_PTR{1} << cpu;
+    }
+
+    return SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#else
+    // macOS only supports affinity hints between threads, not pinning to CPUs.
+    return false;
+#endif
+}
+
+bool SetCurrentThreadName(const std::string& name)
+{
+#ifdef FLOW_LINUX
+    return pthread_setname_np(pthread_self(), name.substr(0, 15).c_str()) == 0;
+#elif defined(FLOW_APPLE)
+    return pthread_setname_np(name.c_str()) == 0;
+#else
+    const std::wstring wide_name(name.begin(), name.end());
+    return SUCCEEDED(SetThreadDescription(GetCurrentThread(), wide_name.c_str()));
+#endif
+}
+
+FLOW_NAMESPACE_END
@@ -48,4 +48,16 @@ bool TypeRegistry::IsConvertible(std::string_view from_type, std::string_view to
     return _conversions.at(from_type).contains(to_type);
 }
 
+const TypeRegistry::EqualityFunc* TypeRegistry::GetEquality(std::string_view type) const
+{
+    auto found = _equalities.find(type);
+    return found != _equalities.end() ? &found->second : nullptr;
+}
+
+const TypeRegistry::HashFunc* TypeRegistry::GetHash(std::string_view type) const
+{
+    auto found = _hashes.find(type);
+    return found != _hashes.end() ? &found->second : nullptr;
+}
+
 FLOW_NAMESPACE_END
@@ -0,0 +1,94 @@
+// Copyright (c) 2024, Cisco Systems, Inc.
+// All rights reserved.
+
+#include "flow/core/Connection.hpp"
+#include "flow/core/NodeData.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace flow;
+
+namespace
+{
+Connection MakeConnection() { return Connection(UUID{}, "out", UUID{}, "in"); }
+
+int PopInt(Connection& conn)
+{
+    Envelope envelope;
+    EXPECT_TRUE(conn.Pop(envelope));
+    return CastNodeData<int>(envelope.Data)->Get();
+}
+} // namespace
+
+TEST(ConnectionTest, UnboundedQueue)
+{
+    auto conn = MakeConnection();
+
+    EXPECT_EQ(conn.GetCapacity(), 0);
+    EXPECT_EQ(conn.Push({MakeNodeData(1)}), PushResult::Schedule);
+    EXPECT_EQ(conn.Push({MakeNodeData(2)}), PushResult::Queued);
+    EXPECT_EQ(conn.QueueSize(), 2);
+
+    EXPECT_EQ(PopInt(conn), 1);
+    EXPECT_EQ(PopInt(conn), 2);
+
+    Envelope envelope;
+    EXPECT_FALSE(conn.Pop(envelope));
+
+    // Once drained, the next push has to schedule a new drain.
+    EXPECT_EQ(conn.Push({MakeNodeData(3)}), PushResult::Schedule);
+}
+
+TEST(ConnectionTest, DropNewest)
+{
+    auto conn = MakeConnection();
+    conn.SetCapacity(2, OverflowPolicy::DropNewest);
+
+    EXPECT_EQ(conn.Push({MakeNodeData(1)}), PushResult::Schedule);
+    EXPECT_EQ(conn.Push({MakeNodeData(2)}), PushResult::Queued);
+    EXPECT_EQ(conn.Push({MakeNodeData(3)}), PushResult::Dropped);
+    EXPECT_EQ(conn.DroppedCount(), 1);
+
+    EXPECT_EQ(PopInt(conn), 1);
+    EXPECT_EQ(PopInt(conn), 2);
+}
+
+TEST(ConnectionTest, DropOldest)
+{
+    auto conn = MakeConnection();
+    conn.SetCapacity(2, OverflowPolicy::DropOldest);
+
+    EXPECT_EQ(conn.Push({MakeNodeData(1)}), PushResult::Schedule);
+    EXPECT_EQ(conn.Push({MakeNodeData(2)}), PushResult::Queued);
+    EXPECT_EQ(conn.Push({MakeNodeData(3)}), PushResult::Dropped);
+    EXPECT_EQ(conn.DroppedCount(), 1);
+
+    EXPECT_EQ(PopInt(conn), 2);
+    EXPECT_EQ(PopInt(conn), 3);
+}
+
+TEST(ConnectionTest, Block)
+{
+    auto conn = MakeConnection();
+    conn.SetCapacity(1, OverflowPolicy::Block);
+
+    EXPECT_EQ(conn.Push({MakeNodeData(1)}), PushResult::Schedule);
+    EXPECT_EQ(conn.Push({MakeNodeData(2)}), PushResult::Full);
+    EXPECT_EQ(conn.DroppedCount(), 0);
+
+    EXPECT_EQ(PopInt(conn), 1);
+    EXPECT_EQ(conn.Push({MakeNodeData(2)}), PushResult::Queued);
+    EXPECT_EQ(PopInt(conn), 2);
+}
+
+TEST(ConnectionTest, SequencedData)
+{
+    auto conn = MakeConnection();
+
+    conn.Push({MakeNodeData(1), std::make_shared<RunContext>(7)});
+
+    Envelope envelope;
+    ASSERT_TRUE(conn.Pop(envelope));
+    ASSERT_NE(envelope.Context, nullptr);
+    EXPECT_EQ(envelope.Context->Sequence(), 7);
+}
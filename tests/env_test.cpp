@@ -0,0 +1,218 @@
+// Copyright (c) 2024, Cisco Systems, Inc.
+// All rights reserved.
+
+#include "flow/core/Env.hpp"
+#include "flow/core/Graph.hpp"
+#include "flow/core/NodeFactory.hpp"
+#include "flow/core/TimerSourceNode.hpp"
+#include "flow/core/TimerWheel.hpp"
+#include "flow/core/Topology.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <latch>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#ifdef FLOW_LINUX
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using namespace flow;
+using namespace std::chrono_literals;
+
+TEST(EnvTest, PriorityLanes)
+{
+    auto env = Env::Create(std::make_shared<NodeFactory>(), Settings{.MaxThreads = 1});
+
+    std::latch blocked(1);
+    std::latch release(1);
+    env->AddTask([&] {
+        blocked.count_down();
+        release.wait();
+    });
+    blocked.wait();
+
+    std::mutex mutex;
+    std::vector<Priority> order;
+    const auto record = [&](Priority priority) {
+        std::lock_guard _(mutex);
+        order.push_back(priority);
+    };
+
+    env->AddPriorityTask(MakePriority(Priority::Background), record, Priority::Background);
+    env->AddPriorityTask(MakePriority(Priority::Normal), record, Priority::Normal);
+    env->AddPriorityTask(MakePriority(Priority::Realtime), record, Priority::Realtime);
+
+    release.count_down();
+    env->Wait();
+
+    EXPECT_EQ(order, (std::vector{Priority::Realtime, Priority::Normal, Priority::Background}));
+}
+
+TEST(EnvTest, PriorityOffsets)
+{
+    EXPECT_EQ(MakePriority(Priority::Normal, 10), 10);
+    EXPECT_EQ(MakePriority(Priority::Normal, 1000), MakePriority(Priority::Realtime) - 1);
+    EXPECT_LT(MakePriority(Priority::Background, 1000), MakePriority(Priority::Normal));
+}
+
+TEST(EnvTest, TimerWheel)
+{
+    TimerWheel timers;
+
+    // Only timers that cannot expire during the test are counted, since the others may fire at any time.
+    std::atomic<int> cancelled = 0;
+    auto id                    = timers.Add(1h, [&] { ++cancelled; });
+    EXPECT_EQ(timers.Size(), 1);
+
+    constexpr int count = 500;
+    std::latch fired(count);
+    for (int i = 0; i < count; ++i)
+    {
+        // Spread the expiries over several levels of the wheel.
+        timers.Add(std::chrono::microseconds(i * i), [&] { fired.count_down(); });
+    }
+
+    fired.wait();
+    EXPECT_EQ(timers.Size(), 1);
+    EXPECT_TRUE(timers.Cancel(id));
+    EXPECT_FALSE(timers.Cancel(id));
+    EXPECT_EQ(timers.Size(), 0);
+    EXPECT_EQ(cancelled, 0);
+}
+
+TEST(EnvTest, Timers)
+{
+    auto env = Env::Create(std::make_shared<NodeFactory>());
+
+    std::latch once(1);
+    env->AddTimer(1ms, [&] { once.count_down(); });
+    once.wait();
+
+    std::atomic<int> never = 0;
+    EXPECT_TRUE(env->CancelTimer(env->AddTimer(50ms, [&] { ++never; })));
+
+    std::latch periodic(5);
+    std::atomic<int> count = 0;
+    auto id                = env->AddPeriodicTimer(2ms, [&] {
+        if (count++ < 5) periodic.count_down();
+    });
+    periodic.wait();
+    EXPECT_TRUE(env->CancelTimer(id));
+    env->Wait();
+
+    EXPECT_EQ(never, 0);
+}
+
+TEST(EnvTest, TimerSourceNode)
+{
+    auto env   = Env::Create(std::make_shared<NodeFactory>());
+    auto graph = std::make_shared<Graph>("test", env);
+    auto timer = std::make_shared<TimerSourceNode>(UUID{}, "timer", env);
+    graph->AddNode(timer);
+
+    timer->SetInputData("interval", MakeNodeData(2ms), false);
+
+    std::latch ticks(3);
+    std::atomic<int> count = 0;
+    timer->OnSetOutput.Bind("ticks", [&](const IndexableName&, const SharedNodeData&) {
+        if (count++ < 3) ticks.count_down();
+    });
+
+    timer->Start();
+    EXPECT_TRUE(timer->IsRunning());
+    ticks.wait();
+
+    timer->Stop();
+    EXPECT_FALSE(timer->IsRunning());
+    env->Wait();
+
+    EXPECT_GE(timer->GetOutputData<std::uint64_t>("tick")->Get(), 3u);
+}
+
+TEST(EnvTest, SpinWorkers)
+{
+    auto env = Env::Create(std::make_shared<NodeFactory>(),
+                           Settings{.MaxThreads = 1, .SpinWorkers = 1, .SpinBudget = std::chrono::microseconds(50)});
+
+    // Realtime tasks still run while the only pool worker is busy.
+    std::latch release(1);
+    env->AddTask([&] { release.wait(); });
+
+    std::atomic<int> count = 0;
+    for (int i = 0; i < 100; ++i)
+    {
+        env->AddPriorityTask(MakePriority(Priority::Realtime), [&] {
+            if (++count == 100) release.count_down();
+        });
+
+        // Let the spin worker park between some of the tasks.
+        if (i % 10 == 0) std::this_thread::sleep_for(200us);
+    }
+
+    env->Wait();
+    EXPECT_EQ(count, 100);
+
+    // Exceptions thrown by realtime tasks are reported instead of swallowed.
+    std::atomic<int> errors = 0;
+    env->OnError.Bind("test", [&](const std::exception& e) {
+        EXPECT_STREQ(e.what(), "realtime");
+        ++errors;
+    });
+    env->AddPriorityTask(MakePriority(Priority::Realtime), [] { throw std::runtime_error("realtime"); });
+    env->Wait();
+    EXPECT_EQ(errors, 1);
+}
+
+TEST(EnvTest, SpinPool)
+{
+    SpinPool pool(2, SpinPool::unlimited_spin);
+
+    std::atomic<int> count = 0;
+    for (int i = 0; i < 1000; ++i)
+    {
+        pool.Push([&] { ++count; });
+    }
+
+    pool.Wait();
+    EXPECT_EQ(count, 1000);
+    EXPECT_EQ(pool.Pending(), 0u);
+}
+
+#ifdef FLOW_LINUX
+TEST(EnvTest, WorkerPlacement)
+{
+    ASSERT_GE(GetNumaNodeCount(), 1u);
+
+    auto env = Env::Create(std::make_shared<NodeFactory>(),
+                           Settings{.MaxThreads = 2, .WorkerAffinity = {{0}}, .ThreadNamePrefix = "test-"});
+
+    std::mutex mutex;
+    std::vector<std::string> names;
+    std::vector<int> cpus;
+    for (int i = 0; i < 8; ++i)
+    {
+        env->AddTask([&] {
+            char name[16] = {};
+            pthread_getname_np(pthread_self(), name, sizeof(name));
+
+            std::lock_guard _(mutex);
+            names.emplace_back(name);
+            cpus.push_back(sched_getcpu());
+        });
+    }
+    env->Wait();
+
+    for (const auto& name : names)
+    {
+        EXPECT_TRUE(name == "test-0" || name == "test-1") << name;
+    }
+    EXPECT_TRUE(std::ranges::all_of(cpus, [](int cpu) { return cpu == 0; }));
+}
+#endif
@@ -2,13 +2,29 @@
 // All rights reserved.
 
 #include "flow/core/Env.hpp"
+#include "flow/core/FunctionNode.hpp"
 #include "flow/core/Graph.hpp"
+#include "flow/core/GraphOptimizer.hpp"
+#include "flow/core/GraphTemplate.hpp"
 #include "flow/core/Node.hpp"
 #include "flow/core/NodeData.hpp"
 #include "flow/core/NodeFactory.hpp"
+#include "flow/core/ObserverChannel.hpp"
+#include "flow/core/RunArena.hpp"
+#include "flow/core/RunContext.hpp"
+#include "flow/core/SubgraphNode.hpp"
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <latch>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
 using namespace flow;
 
 namespace
@@ -38,6 +54,36 @@ struct TestNode : public Node
         }
     }
 };
+
+struct SinkNode : public Node
+{
+    SinkNode() : Node(UUID{}, TypeName_v<SinkNode>, "Sink", env) { AddInput<int>("in", ""); }
+
+    void Compute() override {}
+};
+
+int add(int a, int b) { return a + b; }
+
+using AddNode = FunctionNode<decltype(add), add>;
+
+struct PollingNode : public Node
+{
+    PollingNode() : Node(UUID{}, TypeName_v<PollingNode>, "Polling", env) { AddOutput<int>("out", ""); }
+
+    void Compute() override
+    {
+        const auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (!StopRequested() && std::chrono::steady_clock::now() < timeout)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        stopped = StopRequested();
+        SetOutputData("out", MakeNodeData<int>(1));
+    }
+
+    std::atomic<bool> stopped = false;
+};
 } // namespace
 
 TEST(GraphTest, Construction) { ASSERT_NO_THROW(auto graph = std::make_shared<Graph>("test", env)); }
@@ -210,3 +256,1086 @@ TEST(GraphTest, DistinguishNodes)
         EXPECT_EQ(orphan_nodes.size(), 1);
     }
 }
+
+TEST(GraphTest, BoundedConnection)
+{
+    auto graph = std::make_shared<Graph>("test", env);
+    auto node1 = std::make_shared<::TestNode>();
+    auto node2 = std::make_shared<::TestNode>();
+
+    graph->AddNode(node1);
+    graph->AddNode(node2);
+    auto conn = graph->ConnectNodes(node1->ID(), "out", node2->ID(), "in");
+    conn->SetCapacity(1, OverflowPolicy::Block);
+
+    for (int i = 0; i < 100; ++i)
+    {
+        node1->SetInputData("in", MakeNodeData<int>(i));
+        EXPECT_LE(conn->QueueSize(), 1);
+    }
+
+    env->Wait();
+
+    EXPECT_EQ(conn->QueueSize(), 0);
+    EXPECT_EQ(conn->DroppedCount(), 0);
+    ASSERT_NE(node2->GetInputData<int>("in"), nullptr);
+    EXPECT_EQ(node2->GetInputData<int>("in")->Get(), 99);
+}
+
+TEST(GraphTest, BoundedCycle)
+{
+    // Emits each new value of in once, so that feeding out back into other_in ends.
+    struct EchoNode : public ::TestNode
+    {
+        void Compute() override
+        {
+            if (auto data = GetInputData<int>("in"); data && data->Get() != last)
+            {
+                last = data->Get();
+                SetOutputData("out", MakeNodeData<int>(last));
+            }
+            if (auto data = GetInputData<int>("other_in"))
+            {
+                SetOutputData("other_out", MakeNodeData<int>(data->Get()));
+            }
+        }
+
+        int last = -1;
+    };
+
+    auto graph = std::make_shared<Graph>("test", env);
+    auto node  = std::make_shared<EchoNode>();
+
+    graph->AddNode(node);
+    graph->ConnectNodes(node->ID(), "out", node->ID(), "other_in")->SetCapacity(1, OverflowPolicy::Block);
+
+    // The node is locked while it emits, as when computed by the graph, so the data it feeds back into itself can
+    // neither be delivered on this thread nor wait for space in the full queue.
+    for (int i = 0; i < 100; ++i)
+    {
+        std::lock_guard _(*node);
+        node->SetInputData("in", MakeNodeData<int>(i));
+    }
+
+    env->Wait();
+
+    ASSERT_NE(node->GetOutputData<int>("other_out"), nullptr);
+    EXPECT_EQ(node->GetOutputData<int>("other_out")->Get(), 99);
+}
+
+TEST(GraphTest, BoundedCycleAcrossThreads)
+{
+    auto graph = std::make_shared<Graph>("test", env);
+    auto node1 = std::make_shared<::TestNode>();
+    auto node2 = std::make_shared<::TestNode>();
+
+    graph->AddNode(node1);
+    graph->AddNode(node2);
+    auto forward  = graph->ConnectNodes(node1->ID(), "out", node2->ID(), "other_in");
+    auto backward = graph->ConnectNodes(node2->ID(), "out", node1->ID(), "other_in");
+    forward->SetCapacity(1, OverflowPolicy::Block);
+    backward->SetCapacity(1, OverflowPolicy::Block);
+
+    // Both queues are full, and each thread holds the consumer of the other, so neither can free space for the other.
+    forward->Push({MakeNodeData<int>(0), nullptr});
+    backward->Push({MakeNodeData<int>(0), nullptr});
+
+    std::latch locked(2);
+    auto emit = [&](const std::shared_ptr<::TestNode>& node, int value) {
+        std::lock_guard _(*node);
+        locked.arrive_and_wait();
+        node->SetInputData("in", MakeNodeData<int>(value));
+    };
+
+    {
+        std::jthread thread1(emit, node1, 1);
+        std::jthread thread2(emit, node2, 2);
+    }
+
+    EXPECT_EQ(forward->DroppedCount(), 0);
+    EXPECT_EQ(backward->DroppedCount(), 0);
+}
+
+TEST(GraphTest, ConflatingNode)
+{
+    auto graph = std::make_shared<Graph>("test", env);
+    auto node1 = std::make_shared<::TestNode>();
+    auto node2 = std::make_shared<::TestNode>();
+
+    // The first compute is held until all other values arrived, which are then conflated into a single compute.
+    std::latch entered(1);
+    std::latch release(1);
+    std::atomic<int> computes = 0;
+    node2->SetInputMode(InputMode::Conflating);
+    node2->OnCompute.Bind("count", [&] {
+        if (computes++ == 0)
+        {
+            entered.count_down();
+            release.wait();
+        }
+    });
+
+    graph->AddNode(node1);
+    graph->AddNode(node2);
+    auto conn = graph->ConnectNodes(node1->ID(), "out", node2->ID(), "in");
+
+    node1->SetInputData("in", MakeNodeData<int>(0));
+    entered.wait();
+
+    for (int i = 1; i < 1000; ++i)
+    {
+        node1->SetInputData("in", MakeNodeData<int>(i));
+    }
+
+    // Data popped from the queue becomes pending under the connection lock, so all of it is pending once both are done.
+    while (conn->QueueSize() > 0)
+    {
+        std::this_thread::yield();
+    }
+    {
+        std::lock_guard _(*conn);
+    }
+
+    release.count_down();
+    env->Wait();
+
+    EXPECT_EQ(computes, 2);
+    ASSERT_NE(node2->GetInputData<int>("in"), nullptr);
+    EXPECT_EQ(node2->GetInputData<int>("in")->Get(), 999);
+    EXPECT_EQ(node2->GetOutputData<int>("out")->Get(), 999);
+}
+
+TEST(GraphTest, OrderedNode)
+{
+    auto graph  = std::make_shared<Graph>("test", env);
+    auto source = std::make_shared<::TestNode>();
+    auto left   = std::make_shared<::TestNode>();
+    auto right  = std::make_shared<::TestNode>();
+    auto sink   = std::make_shared<::TestNode>();
+
+    std::vector<std::uint64_t> sequences;
+    bool matched = true;
+    sink->SetInputMode(InputMode::Ordered);
+    sink->OnCompute.Bind("check", [&] {
+        sequences.push_back(Graph::CurrentSequence());
+        matched &= sink->GetInputData<int>("in")->Get() == sink->GetInputData<int>("other_in")->Get();
+    });
+
+    graph->AddNode(source);
+    graph->AddNode(left);
+    graph->AddNode(right);
+    graph->AddNode(sink);
+    graph->ConnectNodes(source->ID(), "out", left->ID(), "in");
+    graph->ConnectNodes(source->ID(), "out", right->ID(), "in");
+    graph->ConnectNodes(left->ID(), "out", sink->ID(), "in");
+    graph->ConnectNodes(right->ID(), "out", sink->ID(), "other_in");
+
+    for (int i = 0; i < 100; ++i)
+    {
+        {
+            std::lock_guard _(*source);
+            source->SetInputData("in", MakeNodeData<int>(i), false);
+        }
+
+        graph->Run();
+    }
+
+    env->Wait();
+
+    ASSERT_FALSE(sequences.empty());
+    EXPECT_TRUE(matched);
+    EXPECT_TRUE(std::is_sorted(sequences.begin(), sequences.end()));
+    EXPECT_EQ(std::adjacent_find(sequences.begin(), sequences.end()), sequences.end());
+    EXPECT_EQ(sequences.back(), 100);
+}
+
+TEST(GraphTest, OrderedSkippedInput)
+{
+    // Emits copies of its input, so that buffered values are not modified by later runs. With even_only, odd values
+    // are skipped, like unchanged outputs suppressed by change detection.
+    struct CopyNode : public ::TestNode
+    {
+        explicit CopyNode(bool even_only) : even_only{even_only} {}
+
+        void Compute() override
+        {
+            if (auto data = GetInputData<int>("in"); data && (!even_only || data->Get() % 2 == 0))
+            {
+                SetOutputData("out", MakeNodeData<int>(data->Get()));
+            }
+        }
+
+        bool even_only;
+    };
+
+    auto graph  = std::make_shared<Graph>("test", env);
+    auto source = std::make_shared<::TestNode>();
+    auto left   = std::make_shared<CopyNode>(false);
+    auto right  = std::make_shared<CopyNode>(true);
+    auto sink   = std::make_shared<::TestNode>();
+
+    std::vector<std::uint64_t> sequences;
+    bool matched = true;
+    sink->SetInputMode(InputMode::Ordered);
+    sink->OnCompute.Bind("check", [&] {
+        sequences.push_back(Graph::CurrentSequence());
+        const auto value = sink->GetInputData<int>("in")->Get();
+        matched &= sink->GetInputData<int>("other_in")->Get() == value - value % 2;
+    });
+
+    graph->AddNode(source);
+    graph->AddNode(left);
+    graph->AddNode(right);
+    graph->AddNode(sink);
+    graph->ConnectNodes(source->ID(), "out", left->ID(), "in");
+    graph->ConnectNodes(source->ID(), "out", right->ID(), "in");
+    graph->ConnectNodes(left->ID(), "out", sink->ID(), "in");
+    graph->ConnectNodes(right->ID(), "out", sink->ID(), "other_in");
+
+    for (int i = 0; i < 100; ++i)
+    {
+        {
+            std::lock_guard _(*source);
+            source->SetInputData("in", MakeNodeData<int>(i), false);
+        }
+
+        graph->Run();
+        env->Wait();
+    }
+
+    // A run skipped by the right node completes once its next value arrives, which has not happened for the last run.
+    EXPECT_TRUE(matched);
+    EXPECT_EQ(sequences.size(), 99);
+    EXPECT_TRUE(std::is_sorted(sequences.begin(), sequences.end()));
+    EXPECT_EQ(std::adjacent_find(sequences.begin(), sequences.end()), sequences.end());
+}
+
+TEST(GraphTest, RemainingPathLength)
+{
+    auto graph = std::make_shared<Graph>("test", env);
+    auto node1 = std::make_shared<::TestNode>();
+    auto node2 = std::make_shared<::TestNode>();
+    auto node3 = std::make_shared<::TestNode>();
+
+    graph->AddNode(node1);
+    graph->AddNode(node2);
+    graph->AddNode(node3);
+    graph->ConnectNodes(node1->ID(), "out", node2->ID(), "in");
+    graph->ConnectNodes(node2->ID(), "out", node3->ID(), "in");
+    graph->ConnectNodes(node1->ID(), "other_out", node3->ID(), "other_in");
+
+    EXPECT_EQ(graph->GetRemainingPathLength(node1->ID()), 2);
+    EXPECT_EQ(graph->GetRemainingPathLength(node2->ID()), 1);
+    EXPECT_EQ(graph->GetRemainingPathLength(node3->ID()), 0);
+
+    graph->DisconnectNodes(node2->ID(), "out", node3->ID(), "in");
+
+    EXPECT_EQ(graph->GetRemainingPathLength(node1->ID()), 1);
+    EXPECT_EQ(graph->GetRemainingPathLength(node2->ID()), 0);
+}
+
+TEST(GraphTest, CancelledRun)
+{
+    auto graph = std::make_shared<Graph>("test", env);
+    auto node1 = std::make_shared<::TestNode>();
+    auto node2 = std::make_shared<::TestNode>();
+
+    std::atomic<int> computes = 0;
+    node1->OnCompute.Bind("count", [&] { ++computes; });
+    node2->OnCompute.Bind("count", [&] { ++computes; });
+
+    graph->AddNode(node1);
+    graph->AddNode(node2);
+    graph->ConnectNodes(node1->ID(), "out", node2->ID(), "in");
+    node1->SetInputData("in", MakeNodeData<int>(1), false);
+
+    std::stop_source source;
+    source.request_stop();
+    graph->Run(source.get_token());
+    graph->Run({}, std::chrono::steady_clock::now() - std::chrono::seconds(1));
+
+    env->Wait();
+
+    EXPECT_EQ(computes, 0);
+    EXPECT_EQ(node2->GetInputData<int>("in"), nullptr);
+}
+
+TEST(GraphTest, PollCancellation)
+{
+    auto graph  = std::make_shared<Graph>("test", env);
+    auto source = std::make_shared<::PollingNode>();
+    auto sink   = std::make_shared<::TestNode>();
+
+    graph->AddNode(source);
+    graph->AddNode(sink);
+    graph->ConnectNodes(source->ID(), "out", sink->ID(), "in");
+
+    std::stop_source stop;
+    graph->Run(stop.get_token());
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    stop.request_stop();
+
+    env->Wait();
+
+    EXPECT_TRUE(source->stopped);
+    EXPECT_EQ(sink->GetInputData<int>("in"), nullptr);
+}
+
+TEST(GraphTest, Evaluate)
+{
+    auto graph = std::make_shared<Graph>("test", env);
+    std::vector<std::shared_ptr<::TestNode>> nodes;
+    std::vector<std::atomic<int>> computes(5);
+    for (std::size_t i = 0; i < computes.size(); ++i)
+    {
+        auto& node = nodes.emplace_back(std::make_shared<::TestNode>());
+        node->OnCompute.Bind("count", [&, i] { ++computes[i]; });
+        graph->AddNode(node);
+    }
+
+    // A chain of 0 -> 1 -> 2 -> 3, with 4 branching off of 0.
+    graph->ConnectNodes(nodes[0]->ID(), "out", nodes[1]->ID(), "in");
+    graph->ConnectNodes(nodes[1]->ID(), "out", nodes[2]->ID(), "in");
+    graph->ConnectNodes(nodes[2]->ID(), "out", nodes[3]->ID(), "in");
+    graph->ConnectNodes(nodes[0]->ID(), "other_out", nodes[4]->ID(), "in");
+    nodes[0]->SetInputData("in", MakeNodeData<int>(1), false);
+
+    auto result = CastNodeData<int>(graph->Evaluate(nodes[2]->ID(), "out"));
+    env->Wait();
+
+    ASSERT_NE(result, nullptr);
+    EXPECT_EQ(result->Get(), 1);
+    EXPECT_EQ(computes[0], 1);
+    EXPECT_EQ(computes[1], 1);
+    EXPECT_EQ(computes[2], 1);
+    EXPECT_EQ(computes[3], 0);
+    EXPECT_EQ(computes[4], 0);
+
+    // Nothing changed, so every upstream result is reused.
+    graph->Evaluate(nodes[2]->ID(), "out");
+    EXPECT_EQ(computes[0], 1);
+    EXPECT_EQ(computes[1], 1);
+    EXPECT_EQ(computes[2], 1);
+
+    nodes[0]->SetInputData("in", MakeNodeData<int>(5), false);
+    result = CastNodeData<int>(graph->Evaluate(nodes[2]->ID(), "out"));
+    EXPECT_EQ(result->Get(), 5);
+    EXPECT_EQ(computes[0], 2);
+    EXPECT_EQ(computes[1], 2);
+    EXPECT_EQ(computes[2], 2);
+
+    nodes[1]->MarkDirty();
+    auto results = graph->Evaluate({{nodes[2]->ID(), "out"}, {nodes[1]->ID(), "out"}});
+    env->Wait();
+
+    ASSERT_EQ(results.size(), 2);
+    EXPECT_EQ(CastNodeData<int>(results[1])->Get(), 5);
+    EXPECT_EQ(computes[0], 2);
+    EXPECT_EQ(computes[1], 3);
+    EXPECT_EQ(computes[2], 3);
+    EXPECT_EQ(computes[3], 0);
+    EXPECT_EQ(computes[4], 0);
+
+    EXPECT_THROW(graph->Evaluate(UUID{}, "out"), std::invalid_argument);
+    EXPECT_THROW(graph->Evaluate(nodes[0]->ID(), "missing"), std::out_of_range);
+
+    // Spilled outputs are read back when pulled downstream.
+    nodes[0]->GetOutputPort("out")->SetRetention(RetentionPolicy::Spill);
+    nodes[1]->GetOutputPort("out")->SetRetention(RetentionPolicy::Spill);
+    nodes[0]->SetInputData("in", MakeNodeData<int>(41), false);
+    result = CastNodeData<int>(graph->Evaluate(nodes[2]->ID(), "out"));
+    env->Wait();
+
+    ASSERT_NE(result, nullptr);
+    EXPECT_EQ(result->Get(), 41);
+}
+
+TEST(GraphTest, EvaluateCycle)
+{
+    auto graph = std::make_shared<Graph>("test", env);
+    std::vector<std::shared_ptr<::TestNode>> nodes;
+    std::vector<int> order;
+    for (int i = 0; i < 4; ++i)
+    {
+        auto& node = nodes.emplace_back(std::make_shared<::TestNode>());
+        node->OnCompute.Bind("order", [&, i] { order.push_back(i); });
+        graph->AddNode(node);
+    }
+
+    // A chain of 0 -> 1 -> 2 -> 3, where 2 also feeds back into 1.
+    graph->ConnectNodes(nodes[0]->ID(), "out", nodes[1]->ID(), "in");
+    graph->ConnectNodes(nodes[1]->ID(), "out", nodes[2]->ID(), "in");
+    graph->ConnectNodes(nodes[2]->ID(), "out", nodes[1]->ID(), "other_in");
+    graph->ConnectNodes(nodes[2]->ID(), "out", nodes[3]->ID(), "in");
+
+    // The nodes of the cycle share its remaining path, so the nodes upstream of it still come first.
+    EXPECT_EQ(graph->GetRemainingPathLength(nodes[0]->ID()), 2);
+    EXPECT_EQ(graph->GetRemainingPathLength(nodes[1]->ID()), 1);
+    EXPECT_EQ(graph->GetRemainingPathLength(nodes[2]->ID()), 1);
+    EXPECT_EQ(graph->GetRemainingPathLength(nodes[3]->ID()), 0);
+
+    nodes[0]->SetInputData("in", MakeNodeData<int>(5), false);
+    auto result = CastNodeData<int>(graph->Evaluate(nodes[3]->ID(), "out"));
+
+    ASSERT_NE(result, nullptr);
+    EXPECT_EQ(result->Get(), 5);
+    EXPECT_EQ(order, (std::vector{0, 1, 2, 3}));
+
+    // The feedback reaches 1 on the next evaluation.
+    order.clear();
+    graph->Evaluate(nodes[3]->ID(), "out");
+    EXPECT_EQ(order, (std::vector{1, 2, 3}));
+    EXPECT_EQ(nodes[1]->GetOutputData<int>("other_out")->Get(), 5);
+}
+
+TEST(GraphTest, Recompute)
+{
+    auto graph = std::make_shared<Graph>("test", env);
+    std::vector<std::shared_ptr<::TestNode>> nodes;
+    std::vector<std::atomic<int>> computes(4);
+    for (std::size_t i = 0; i < computes.size(); ++i)
+    {
+        auto& node = nodes.emplace_back(std::make_shared<::TestNode>());
+        node->OnCompute.Bind("count", [&, i] { ++computes[i]; });
+        graph->AddNode(node);
+    }
+
+    // A chain of 0 -> 1 -> 2, with 3 branching off of 0.
+    graph->ConnectNodes(nodes[0]->ID(), "out", nodes[1]->ID(), "in");
+    graph->ConnectNodes(nodes[1]->ID(), "out", nodes[2]->ID(), "in");
+    graph->ConnectNodes(nodes[0]->ID(), "other_out", nodes[3]->ID(), "in");
+    nodes[0]->SetInputData("in", MakeNodeData<int>(1), false);
+    nodes[0]->SetInputData("other_in", MakeNodeData<int>(2), false);
+
+    graph->Evaluate({{nodes[2]->ID(), "out"}, {nodes[3]->ID(), "out"}});
+    EXPECT_EQ(graph->Recompute(), 0);
+
+    graph->SetInputData(nodes[1]->ID(), "other_in", MakeNodeData<int>(3));
+    EXPECT_EQ(graph->Recompute(), 2);
+    EXPECT_EQ(graph->Recompute(), 0);
+
+    env->Wait();
+
+    EXPECT_EQ(computes[0], 1);
+    EXPECT_EQ(computes[1], 2);
+    EXPECT_EQ(computes[2], 2);
+    EXPECT_EQ(computes[3], 1);
+
+    // Several edits only compute each affected node once.
+    graph->SetInputData(nodes[0]->ID(), "in", MakeNodeData<int>(4));
+    graph->SetInputData(nodes[1]->ID(), "other_in", MakeNodeData<int>(5));
+    graph->Invalidate(nodes[2]->ID());
+    EXPECT_EQ(graph->Recompute(), 4);
+
+    EXPECT_EQ(computes[0], 2);
+    EXPECT_EQ(computes[1], 3);
+    EXPECT_EQ(computes[2], 3);
+    EXPECT_EQ(computes[3], 2);
+    EXPECT_EQ(nodes[2]->GetOutputData<int>("out")->Get(), 4);
+
+    EXPECT_THROW(graph->SetInputData(UUID{}, "in", nullptr), std::invalid_argument);
+    EXPECT_THROW(graph->Invalidate(UUID{}), std::invalid_argument);
+}
+
+TEST(GraphTest, Optimizer)
+{
+    AddNode::SetPure(true);
+
+    auto graph    = std::make_shared<Graph>("test", env);
+    auto source   = std::make_shared<::TestNode>();
+    auto constant = std::make_shared<AddNode>(UUID{}, "constant", env);
+    auto sum      = std::make_shared<AddNode>(UUID{}, "sum", env);
+    auto copy     = std::make_shared<AddNode>(UUID{}, "copy", env);
+    auto unused   = std::make_shared<AddNode>(UUID{}, "unused", env);
+    auto observed = std::make_shared<AddNode>(UUID{}, "observed", env);
+    auto sink     = std::make_shared<::SinkNode>();
+    auto copy_end = std::make_shared<::SinkNode>();
+
+    const std::vector<SharedNode> all_nodes{source, constant, sum, copy, unused, observed, sink, copy_end};
+    for (const auto& node : all_nodes)
+    {
+        graph->AddNode(node);
+    }
+
+    constant->SetInputData("a", MakeNodeData<int>(1), false);
+    constant->SetInputData("b", MakeNodeData<int>(2), false);
+    copy->SetInputData("a", MakeNodeData<int>(3), false);
+    unused->SetInputData("b", MakeNodeData<int>(5), false);
+
+    graph->ConnectNodes(constant->ID(), "return", sum->ID(), "a");
+    graph->ConnectNodes(source->ID(), "out", sum->ID(), "b");
+    graph->ConnectNodes(source->ID(), "out", copy->ID(), "b");
+    graph->ConnectNodes(source->ID(), "out", unused->ID(), "a");
+    graph->ConnectNodes(source->ID(), "out", observed->ID(), "a");
+    graph->ConnectNodes(sum->ID(), "return", sink->ID(), "in");
+    graph->ConnectNodes(copy->ID(), "return", copy_end->ID(), "in");
+
+    auto optimizer = GraphOptimizer::CreateDefault({{observed->ID(), "return"}});
+    ASSERT_EQ(optimizer.Size(), 5);
+
+    auto reports = optimizer.Run(*graph);
+    ASSERT_EQ(reports.size(), 5);
+    EXPECT_EQ(reports[0].Pass, "SubgraphFlattening");
+    EXPECT_TRUE(reports[0].Changes.empty());
+    reports.erase(reports.begin());
+
+    EXPECT_EQ(reports[0].Pass, "ConstantFolding");
+    EXPECT_EQ(reports[0].RemovedNodes, std::vector<UUID>{constant->ID()});
+    EXPECT_EQ(reports[0].Changes.size(), 1);
+    EXPECT_EQ(sum->GetInputData<int>("a")->Get(), 3);
+    EXPECT_FALSE(sum->GetInputPort("a")->IsConnected());
+
+    EXPECT_EQ(reports[1].Pass, "CommonSubexpressionElimination");
+    ASSERT_EQ(reports[1].RemovedNodes.size(), 1);
+    EXPECT_TRUE(reports[1].RemovedNodes[0] == sum->ID() || reports[1].RemovedNodes[0] == copy->ID());
+
+    EXPECT_EQ(reports[2].Pass, "DeadNodeElimination");
+    EXPECT_EQ(reports[2].RemovedNodes, std::vector<UUID>{unused->ID()});
+
+    EXPECT_EQ(reports[3].Pass, "NodeFusion");
+    EXPECT_TRUE(reports[3].Changes.empty());
+
+    EXPECT_EQ(graph->Size(), 5);
+    EXPECT_EQ(graph->ConnectionCount(), 4);
+
+    source->SetInputData("in", MakeNodeData<int>(4));
+    env->Wait();
+
+    ASSERT_NE(sink->GetInputData<int>("in"), nullptr);
+    ASSERT_NE(copy_end->GetInputData<int>("in"), nullptr);
+    EXPECT_EQ(sink->GetInputData<int>("in")->Get(), 7);
+    EXPECT_EQ(copy_end->GetInputData<int>("in")->Get(), 7);
+
+    AddNode::SetPure(false);
+}
+
+TEST(GraphTest, DeadNodeElimination)
+{
+    auto graph  = std::make_shared<Graph>("test", env);
+    auto source = std::make_shared<::TestNode>();
+    auto f      = std::make_shared<AddNode>(UUID{}, "f", env);
+    auto first  = std::make_shared<AddNode>(UUID{}, "first", env);
+    auto second = std::make_shared<AddNode>(UUID{}, "second", env);
+
+    for (const SharedNode& node : std::vector<SharedNode>{source, f, first, second})
+    {
+        graph->AddNode(node);
+    }
+
+    // The return port of f is read outside of the graph, so f is observed and keeps source alive.
+    graph->ConnectNodes(source->ID(), "out", f->ID(), "a");
+
+    // A cycle without a way out reaches no leaf.
+    graph->ConnectNodes(source->ID(), "other_out", first->ID(), "a");
+    graph->ConnectNodes(first->ID(), "return", second->ID(), "a");
+    graph->ConnectNodes(second->ID(), "return", first->ID(), "b");
+
+    auto reports = GraphOptimizer::CreateDefault({{f->ID(), "return"}}).Run(*graph);
+    ASSERT_EQ(reports.size(), 5);
+    EXPECT_EQ(reports[3].Pass, "DeadNodeElimination");
+
+    auto removed = reports[3].RemovedNodes;
+    std::sort(removed.begin(), removed.end());
+    auto expected = std::vector<UUID>{first->ID(), second->ID()};
+    std::sort(expected.begin(), expected.end());
+    EXPECT_EQ(removed, expected);
+
+    EXPECT_EQ(graph->Size(), 2);
+    EXPECT_NE(graph->GetNode(source->ID()), nullptr);
+    EXPECT_NE(graph->GetNode(f->ID()), nullptr);
+}
+
+TEST(GraphTest, OptimizerObserved)
+{
+    AddNode::SetPure(true);
+
+    auto graph    = std::make_shared<Graph>("test", env);
+    auto source   = std::make_shared<::TestNode>();
+    auto constant = std::make_shared<AddNode>(UUID{}, "constant", env);
+    auto first    = std::make_shared<AddNode>(UUID{}, "first", env);
+    auto second   = std::make_shared<AddNode>(UUID{}, "second", env);
+    auto sink     = std::make_shared<::SinkNode>();
+
+    for (const SharedNode& node : std::vector<SharedNode>{source, constant, first, second, sink})
+    {
+        graph->AddNode(node);
+    }
+
+    constant->SetInputData("a", MakeNodeData<int>(1), false);
+    constant->SetInputData("b", MakeNodeData<int>(2), false);
+    first->SetInputData("b", MakeNodeData<int>(3), false);
+    second->SetInputData("b", MakeNodeData<int>(3), false);
+
+    graph->ConnectNodes(constant->ID(), "return", sink->ID(), "in");
+    graph->ConnectNodes(source->ID(), "out", first->ID(), "a");
+    graph->ConnectNodes(source->ID(), "out", second->ID(), "a");
+
+    // Observed nodes are neither folded nor merged into another node, whichever of the duplicates is visited first.
+    const std::vector<std::pair<UUID, IndexableName>> observed{{constant->ID(), "return"}, {second->ID(), "return"}};
+    auto reports = GraphOptimizer::CreateDefault(observed).Run(*graph);
+    ASSERT_EQ(reports.size(), 5);
+
+    EXPECT_EQ(reports[1].Pass, "ConstantFolding");
+    EXPECT_TRUE(reports[1].RemovedNodes.empty());
+
+    EXPECT_EQ(reports[2].Pass, "CommonSubexpressionElimination");
+    EXPECT_EQ(reports[2].RemovedNodes, std::vector<UUID>{first->ID()});
+
+    EXPECT_EQ(reports[3].Pass, "DeadNodeElimination");
+    EXPECT_TRUE(reports[3].RemovedNodes.empty());
+
+    EXPECT_EQ(graph->Size(), 4);
+    EXPECT_NE(graph->GetNode(constant->ID()), nullptr);
+    EXPECT_NE(graph->GetNode(second->ID()), nullptr);
+
+    AddNode::SetPure(false);
+}
+
+TEST(GraphTest, NodeFusion)
+{
+    Settings settings;
+    settings.MaxInlineDepth = 2;
+
+    auto inline_env = Env::Create(factory, settings);
+    auto graph      = std::make_shared<Graph>("test", inline_env);
+
+    std::vector<std::shared_ptr<::TestNode>> nodes;
+    std::vector<std::thread::id> threads(5);
+    for (std::size_t i = 0; i < threads.size(); ++i)
+    {
+        auto& node = nodes.emplace_back(std::make_shared<::TestNode>());
+        node->OnCompute.Bind("thread", [&, i] { threads[i] = std::this_thread::get_id(); });
+        graph->AddNode(node);
+    }
+
+    // A chain of 0 -> 1 -> 2 -> 3, where 0 also feeds 4, so that only 1 -> 2 -> 3 can be fused.
+    graph->ConnectNodes(nodes[0]->ID(), "out", nodes[1]->ID(), "in");
+    graph->ConnectNodes(nodes[1]->ID(), "out", nodes[2]->ID(), "in");
+    graph->ConnectNodes(nodes[2]->ID(), "out", nodes[3]->ID(), "in");
+    graph->ConnectNodes(nodes[0]->ID(), "other_out", nodes[4]->ID(), "in");
+
+    GraphOptimizer optimizer;
+    optimizer.AddPass<NodeFusion>();
+
+    auto reports = optimizer.Run(*graph);
+    ASSERT_EQ(reports.size(), 1);
+    EXPECT_EQ(reports[0].Changes.size(), 2);
+
+    for (const auto& [_, connection] : graph->GetConnections())
+    {
+        EXPECT_EQ(connection->IsFused(), connection->StartNodeID() != nodes[0]->ID());
+    }
+
+    nodes[1]->SetInputData("in", MakeNodeData<int>(1));
+
+    EXPECT_NE(nodes[3]->GetOutputData<int>("out"), nullptr);
+    EXPECT_EQ(threads[1], std::this_thread::get_id());
+    EXPECT_EQ(threads[2], std::this_thread::get_id());
+    EXPECT_EQ(threads[3], std::this_thread::get_id());
+
+    // Past the inline depth limit, data is queued instead.
+    settings.MaxInlineDepth = 1;
+    graph = std::make_shared<Graph>("test", Env::Create(factory, settings));
+    for (std::size_t i = 1; i < 4; ++i)
+    {
+        nodes[i] = std::make_shared<::TestNode>();
+        nodes[i]->OnCompute.Bind("thread", [&, i] { threads[i] = std::this_thread::get_id(); });
+        graph->AddNode(nodes[i]);
+    }
+
+    graph->ConnectNodes(nodes[1]->ID(), "out", nodes[2]->ID(), "in");
+    graph->ConnectNodes(nodes[2]->ID(), "out", nodes[3]->ID(), "in");
+    optimizer.Run(*graph);
+
+    threads = std::vector<std::thread::id>(5);
+    nodes[1]->SetInputData("in", MakeNodeData<int>(2));
+    graph->GetEnv()->Wait();
+
+    EXPECT_EQ(threads[2], std::this_thread::get_id());
+    EXPECT_NE(threads[3], std::this_thread::get_id());
+    EXPECT_EQ(nodes[3]->GetOutputData<int>("out")->Get(), 2);
+
+    // Connections on a cycle are never fused.
+    graph = std::make_shared<Graph>("test", inline_env);
+    for (std::size_t i = 1; i < 3; ++i)
+    {
+        nodes[i] = std::make_shared<::TestNode>();
+        graph->AddNode(nodes[i]);
+    }
+
+    graph->ConnectNodes(nodes[1]->ID(), "out", nodes[2]->ID(), "in");
+    graph->ConnectNodes(nodes[2]->ID(), "out", nodes[1]->ID(), "in");
+
+    reports = optimizer.Run(*graph);
+    EXPECT_TRUE(reports[0].Changes.empty());
+}
+
+TEST(GraphTest, InlinePolicy)
+{
+    Settings settings;
+    settings.InlineThreshold = std::chrono::seconds(1);
+
+    auto graph = std::make_shared<Graph>("test", Env::Create(factory, settings));
+
+    std::vector<std::shared_ptr<::TestNode>> nodes;
+    std::vector<std::thread::id> threads(4);
+    for (std::size_t i = 0; i < threads.size(); ++i)
+    {
+        auto& node = nodes.emplace_back(std::make_shared<::TestNode>());
+        node->OnCompute.Bind("thread", [&, i] { threads[i] = std::this_thread::get_id(); });
+        graph->AddNode(node);
+    }
+
+    graph->ConnectNodes(nodes[0]->ID(), "out", nodes[1]->ID(), "in");
+    graph->ConnectNodes(nodes[0]->ID(), "other_out", nodes[2]->ID(), "in");
+    graph->ConnectNodes(nodes[0]->ID(), "out", nodes[3]->ID(), "in");
+
+    nodes[1]->SetInlinePolicy(InlinePolicy::Always);
+    nodes[2]->SetInlinePolicy(InlinePolicy::Auto);
+
+    EXPECT_EQ(nodes[2]->GetComputeTime(), std::nullopt);
+    EXPECT_EQ(nodes[3]->GetInlinePolicy(), InlinePolicy::Never);
+
+    // Nodes with the auto policy are queued until their compute time was measured.
+    nodes[0]->SetInputData("other_in", MakeNodeData<int>(1), false);
+    nodes[0]->SetInputData("in", MakeNodeData<int>(1));
+    graph->GetEnv()->Wait();
+
+    EXPECT_EQ(threads[1], std::this_thread::get_id());
+    EXPECT_NE(threads[2], std::this_thread::get_id());
+    EXPECT_NE(threads[3], std::this_thread::get_id());
+    ASSERT_NE(nodes[2]->GetComputeTime(), std::nullopt);
+    EXPECT_EQ(nodes[1]->GetComputeTime(), std::nullopt);
+
+    nodes[0]->SetInputData("in", MakeNodeData<int>(2));
+    graph->GetEnv()->Wait();
+
+    EXPECT_EQ(threads[1], std::this_thread::get_id());
+    EXPECT_EQ(threads[2], std::this_thread::get_id());
+    EXPECT_NE(threads[3], std::this_thread::get_id());
+
+    // Data is queued on bounded connections, so that their capacity and overflow policy hold.
+    auto producer = std::make_shared<::TestNode>();
+    auto consumer = std::make_shared<::TestNode>();
+    std::thread::id consumer_thread;
+    consumer->OnCompute.Bind("thread", [&] { consumer_thread = std::this_thread::get_id(); });
+    consumer->SetInlinePolicy(InlinePolicy::Always);
+    graph->AddNode(producer);
+    graph->AddNode(consumer);
+
+    auto bounded = graph->ConnectNodes(producer->ID(), "out", consumer->ID(), "in");
+    bounded->SetCapacity(1, OverflowPolicy::DropNewest);
+    producer->SetInputData("in", MakeNodeData<int>(3));
+    graph->GetEnv()->Wait();
+
+    EXPECT_NE(consumer_thread, std::this_thread::get_id());
+    EXPECT_EQ(consumer->GetOutputData<int>("out")->Get(), 3);
+
+    // Data is queued behind data that was queued before it, rather than overtaking it.
+    auto queued = graph->ConnectNodes(producer->ID(), "other_out", consumer->ID(), "other_in");
+    queued->Push({MakeNodeData<int>(4), nullptr});
+    producer->SetInputData("other_in", MakeNodeData<int>(5));
+
+    EXPECT_EQ(queued->QueueSize(), 2);
+    EXPECT_EQ(consumer->GetOutputData("other_out"), nullptr);
+}
+
+TEST(GraphTest, SubgraphNode)
+{
+    const auto make_subgraph = [](std::shared_ptr<Graph>& inner) {
+        inner      = std::make_shared<Graph>("inner", env);
+        auto first = std::make_shared<::TestNode>();
+        auto last  = std::make_shared<::TestNode>();
+
+        inner->AddNode(first);
+        inner->AddNode(last);
+        inner->ConnectNodes(first->ID(), "out", last->ID(), "in");
+
+        auto subgraph = std::make_shared<SubgraphNode>(UUID{}, "subgraph", env, inner);
+        subgraph->ExposeInput("value", first->ID(), "in");
+        subgraph->ExposeOutput("result", last->ID(), "out");
+        return subgraph;
+    };
+
+    auto graph  = std::make_shared<Graph>("test", env);
+    auto source = std::make_shared<::TestNode>();
+    auto sink   = std::make_shared<::TestNode>();
+
+    std::shared_ptr<Graph> inner;
+    auto subgraph = make_subgraph(inner);
+
+    EXPECT_THROW(subgraph->ExposeOutput("result", inner->GetNodes().begin()->first, "out"), std::invalid_argument);
+    EXPECT_THROW(subgraph->ExposeInput("value", UUID{}, "in"), std::invalid_argument);
+    EXPECT_THROW(SubgraphNode(UUID{}, "subgraph", env, nullptr), std::invalid_argument);
+
+    graph->AddNode(source);
+    graph->AddNode(subgraph);
+    graph->AddNode(sink);
+    graph->ConnectNodes(source->ID(), "out", subgraph->ID(), "value");
+    graph->ConnectNodes(subgraph->ID(), "result", sink->ID(), "in");
+
+    source->SetInputData("in", MakeNodeData<int>(5));
+    env->Wait();
+
+    ASSERT_NE(sink->GetInputData<int>("in"), nullptr);
+    EXPECT_EQ(sink->GetInputData<int>("in")->Get(), 5);
+    EXPECT_EQ(graph->Size(), 3);
+
+    // Flattening moves the inner nodes into the parent graph.
+    graph    = std::make_shared<Graph>("test", env);
+    source   = std::make_shared<::TestNode>();
+    sink     = std::make_shared<::TestNode>();
+    subgraph = make_subgraph(inner);
+    subgraph->SetMode(SubgraphMode::Flattened);
+
+    graph->AddNode(source);
+    graph->AddNode(subgraph);
+    graph->AddNode(sink);
+    graph->ConnectNodes(source->ID(), "out", subgraph->ID(), "value");
+    graph->ConnectNodes(subgraph->ID(), "result", sink->ID(), "in");
+
+    GraphOptimizer optimizer;
+    optimizer.AddPass<SubgraphFlattening>();
+
+    auto reports = optimizer.Run(*graph);
+    ASSERT_EQ(reports.size(), 1);
+    EXPECT_EQ(reports[0].RemovedNodes, std::vector<UUID>{subgraph->ID()});
+    EXPECT_EQ(graph->Size(), 4);
+    EXPECT_EQ(graph->ConnectionCount(), 3);
+    EXPECT_EQ(inner->Size(), 0);
+
+    source->SetInputData("in", MakeNodeData<int>(7));
+    env->Wait();
+
+    ASSERT_NE(sink->GetInputData<int>("in"), nullptr);
+    EXPECT_EQ(sink->GetInputData<int>("in")->Get(), 7);
+}
+
+TEST(GraphTest, GraphTemplate)
+{
+    auto graph  = std::make_shared<Graph>("test", env);
+    auto first  = std::make_shared<::TestNode>();
+    auto second = std::make_shared<::TestNode>();
+    auto last   = std::make_shared<::TestNode>();
+
+    graph->AddNode(first);
+    graph->AddNode(second);
+    graph->AddNode(last);
+    graph->ConnectNodes(first->ID(), "out", second->ID(), "in");
+    graph->ConnectNodes(second->ID(), "out", last->ID(), "in");
+
+    EXPECT_THROW(GraphTemplate::Create(nullptr), std::invalid_argument);
+
+    auto graph_template = GraphTemplate::Create(graph);
+    EXPECT_EQ(graph_template->NodeCount(), 3);
+    EXPECT_EQ(graph_template->SlotCount(), 12);
+
+    auto a = graph_template->Instantiate();
+    auto b = graph_template->Instantiate();
+
+    EXPECT_THROW(a->SetInputData(UUID{}, "in", MakeNodeData<int>(1)), std::invalid_argument);
+    EXPECT_THROW(a->SetInputData(first->ID(), "missing", MakeNodeData<int>(1)), std::out_of_range);
+
+    a->SetInputData(first->ID(), "in", MakeNodeData<int>(1));
+    b->SetInputData(first->ID(), "in", MakeNodeData<int>(2));
+
+    EXPECT_EQ(a->Run(), 3);
+    EXPECT_EQ(b->Run(), 3);
+
+    auto a_result = std::dynamic_pointer_cast<NodeData<int>>(a->GetOutputData(last->ID(), "out"));
+    auto b_result = std::dynamic_pointer_cast<NodeData<int>>(b->GetOutputData(last->ID(), "out"));
+    ASSERT_NE(a_result, nullptr);
+    ASSERT_NE(b_result, nullptr);
+    EXPECT_EQ(a_result->Get(), 1);
+    EXPECT_EQ(b_result->Get(), 2);
+
+    // Nothing changed since the last run.
+    EXPECT_EQ(a->Run(), 0);
+
+    b->SetInputData(first->ID(), "in", MakeNodeData<int>(3));
+    b->Schedule();
+    env->Wait();
+
+    b_result = std::dynamic_pointer_cast<NodeData<int>>(b->GetOutputData(last->ID(), "out"));
+    ASSERT_NE(b_result, nullptr);
+    EXPECT_EQ(b_result->Get(), 3);
+
+    a_result = std::dynamic_pointer_cast<NodeData<int>>(a->GetOutputData(last->ID(), "out"));
+    EXPECT_EQ(a_result->Get(), 1);
+}
+
+TEST(GraphTest, RunBatch)
+{
+    auto graph = std::make_shared<Graph>("test", env);
+    auto first = std::make_shared<::TestNode>();
+    auto last  = std::make_shared<::TestNode>();
+
+    graph->AddNode(first);
+    graph->AddNode(last);
+    graph->ConnectNodes(first->ID(), "out", last->ID(), "in");
+
+    auto graph_template = GraphTemplate::Create(graph);
+
+    std::vector<GraphTemplate::RunInputs> inputs;
+    for (int i = 0; i < 100; ++i)
+    {
+        inputs.push_back({{first->ID(), "in", MakeNodeData<int>(i)}});
+    }
+
+    const std::vector<std::pair<UUID, IndexableName>> outputs{{last->ID(), "out"}, {last->ID(), "other_out"}};
+
+    EXPECT_THROW(std::ignore = graph_template->RunBatch(inputs, {{last->ID(), "missing"}}), std::out_of_range);
+
+    auto results = graph_template->RunBatch(inputs, outputs);
+    ASSERT_EQ(results.size(), inputs.size());
+    for (int i = 0; i < 100; ++i)
+    {
+        ASSERT_EQ(results[i].size(), 2);
+        auto result = std::dynamic_pointer_cast<NodeData<int>>(results[i][0]);
+        ASSERT_NE(result, nullptr);
+        EXPECT_EQ(result->Get(), i);
+        EXPECT_EQ(results[i][1], nullptr);
+    }
+
+    // Called from the only worker of the pool, the caller has to take the runs itself.
+    Settings settings;
+    settings.MaxThreads = 1;
+
+    auto single_env = Env::Create(factory, settings);
+    auto single     = std::make_shared<Graph>("single", single_env);
+    single->AddNode(first);
+    single->AddNode(last);
+    single->ConnectNodes(first->ID(), "out", last->ID(), "in");
+
+    std::size_t completed = 0;
+    single_env->AddTask([&] { completed = GraphTemplate::Create(single)->RunBatch(inputs, outputs).size(); });
+    single_env->Wait();
+    EXPECT_EQ(completed, inputs.size());
+}
+
+TEST(GraphTest, ObserverChannel)
+{
+    auto node = std::make_shared<::TestNode>();
+
+    {
+        // An interval long enough that only explicit flushes deliver.
+        ObserverChannel channel(std::chrono::hours{1});
+        EXPECT_THROW(channel.Observe(node, "missing"), std::out_of_range);
+
+        std::vector<ObservedUpdate> delivered;
+        channel.OnUpdates.Bind("test", [&](const auto& updates) { delivered = updates; });
+        channel.Observe(node, "out");
+
+        for (int i = 0; i < 100; ++i)
+        {
+            node->SetInputData("in", MakeNodeData<int>(i));
+        }
+
+        // Only the latest value is delivered.
+        EXPECT_EQ(channel.Flush(), 1);
+        ASSERT_EQ(delivered.size(), 1);
+        EXPECT_EQ(delivered[0].NodeID, node->ID());
+        EXPECT_EQ(CastNodeData<int>(delivered[0].Data)->Get(), 99);
+        EXPECT_EQ(channel.Flush(), 0);
+
+        EXPECT_TRUE(channel.Unobserve(node->ID(), "out"));
+        EXPECT_FALSE(channel.Unobserve(node->ID(), "out"));
+        node->SetInputData("in", MakeNodeData(100));
+        EXPECT_EQ(channel.Flush(), 0);
+    }
+
+    ObserverChannel channel(std::chrono::milliseconds{1});
+    channel.Observe(node, "out");
+
+    std::atomic<int> latest = -1;
+    channel.OnUpdates.Bind("test", [&](const auto& updates) { latest = CastNodeData<int>(updates[0].Data)->Get(); });
+
+    node->SetInputData("in", MakeNodeData(7));
+    for (int i = 0; i < 1000 && latest != 7; ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+
+    EXPECT_EQ(latest, 7);
+}
+
+TEST(GraphTest, RunArena)
+{
+    SharedNodeData data;
+    std::weak_ptr<RunArena> weak_arena;
+    {
+        auto arena = std::make_shared<RunArena>(4096);
+        weak_arena = arena;
+
+        RunContext::Scope scope(std::make_shared<const RunContext>(1, std::stop_token{}, std::nullopt, arena));
+        EXPECT_EQ(RunArena::Current(), arena.get());
+
+        data = MakeNodeData<int>(42);
+        EXPECT_GT(arena->BytesAllocated(), 0);
+        EXPECT_EQ(arena->ChunkCount(), 1);
+
+        // Data too large for a chunk is made on the heap.
+        const auto allocated = arena->BytesAllocated();
+        std::ignore          = MakeNodeData(std::array<std::byte, 2048>{});
+        EXPECT_EQ(arena->BytesAllocated(), allocated);
+    }
+
+    EXPECT_EQ(RunArena::Current(), nullptr);
+
+    // Data that escaped the run keeps its arena alive until it is released.
+    EXPECT_FALSE(weak_arena.expired());
+    EXPECT_EQ(CastNodeData<int>(data)->Get(), 42);
+
+    data.reset();
+    EXPECT_TRUE(weak_arena.expired());
+
+    // Ports keep the data of a run in its arena while the run is in flight, and a copy on the heap once it completed.
+    struct ArenaNode : public ::TestNode
+    {
+        void Compute() override
+        {
+            SetOutputData("out", MakeNodeData<int>(7));
+            in_arena = GetOutputData("out")->IsInArena();
+            arena    = RunArena::Current()->weak_from_this();
+        }
+
+        bool in_arena = false;
+        std::weak_ptr<RunArena> arena;
+    };
+
+    auto arena_env   = Env::Create(factory, Settings{.RunArenaChunkSize = 4096});
+    auto arena_graph = std::make_shared<Graph>("test", arena_env);
+    auto node        = std::make_shared<ArenaNode>();
+    auto sink        = std::make_shared<SinkNode>();
+    arena_graph->AddNode(node);
+    arena_graph->AddNode(sink);
+    arena_graph->ConnectNodes(node->ID(), "out", sink->ID(), "in");
+    arena_graph->Run();
+    arena_env->Wait();
+
+    const auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!node->arena.expired() && std::chrono::steady_clock::now() < timeout)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+
+    EXPECT_TRUE(node->in_arena);
+    EXPECT_TRUE(node->arena.expired());
+    EXPECT_FALSE(node->GetOutputData("out")->IsInArena());
+    EXPECT_EQ(node->GetOutputData<int>("out")->Get(), 7);
+
+    // A thread alternating between arenas keeps allocating from the same chunk of each.
+    auto first  = std::make_shared<RunArena>(4096);
+    auto second = std::make_shared<RunArena>(4096);
+    for (int i = 0; i < 10; ++i)
+    {
+        for (const auto& arena : {first, second})
+        {
+            RunArena::Scope scope(arena.get());
+            std::ignore = MakeNodeData<int>(i);
+        }
+    }
+
+    EXPECT_EQ(first->ChunkCount(), 1);
+    EXPECT_EQ(second->ChunkCount(), 1);
+}
@@ -1,8 +1,12 @@
 // Copyright (c) 2024, Cisco Systems, Inc.
 // All rights reserved.
 
+#include "flow/core/Column.hpp"
 #include "flow/core/Env.hpp"
 #include "flow/core/FunctionNode.hpp"
+#include "flow/core/Graph.hpp"
+#include "flow/core/IngressNode.hpp"
+#include "flow/core/MPSCQueue.hpp"
 #include "flow/core/Node.hpp"
 #include "flow/core/NodeData.hpp"
 #include "flow/core/NodeFactory.hpp"
@@ -10,6 +14,18 @@
 #include <gtest/gtest.h>
 #include <nlohmann/json.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <latch>
+#include <map>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
 using namespace flow;
 
 namespace test
@@ -23,7 +39,10 @@ namespace NodeTest
 
 struct TestNode : public Node
 {
-    TestNode() : Node(UUID{}, TypeName_v<TestNode>, "Test", test::env) {}
+    explicit TestNode(std::shared_ptr<Env> env = test::env) : Node(UUID{}, TypeName_v<TestNode>, "Test", std::move(env))
+    {
+    }
+
     void Compute() override
     {
         if (auto data = GetInputData<int>("in"))
@@ -175,3 +194,440 @@ TEST(NodeTest, WrapFunctions)
     ASSERT_EQ(return_node.GetOutputPorts().size(), 1);
     ASSERT_EQ(return_ref_node.GetOutputPorts().size(), 2);
 }
+
+TEST(NodeTest, MPSCQueue)
+{
+    constexpr int producers = 4;
+    constexpr int count     = 10000;
+
+    MPSCQueue<std::pair<int, int>> queue;
+
+    std::vector<std::jthread> threads;
+    for (int p = 0; p < producers; ++p)
+    {
+        threads.emplace_back([&, p] {
+            for (int i = 0; i < count; ++i)
+            {
+                queue.Push({p, i});
+            }
+        });
+    }
+
+    std::vector<int> next(producers, 0);
+    std::pair<int, int> value;
+    for (int popped = 0; popped < producers * count;)
+    {
+        if (queue.TryPop(value))
+        {
+            ASSERT_EQ(value.second, next[value.first]++);
+            ++popped;
+        }
+    }
+
+    EXPECT_FALSE(queue.TryPop(value));
+}
+
+TEST(NodeTest, IngressNode)
+{
+    constexpr int producers = 4;
+    constexpr int count     = 25000;
+
+    auto graph = std::make_shared<Graph>("test", test::env);
+    auto node  = std::make_shared<IngressNode<int>>(UUID{}, "ingress", test::env);
+    graph->AddNode(node);
+    node->SetBatchSize(512);
+
+    std::atomic<int> received = 0;
+    std::atomic<std::size_t> largest = 0;
+    std::latch done(1);
+    node->OnSetOutput.Bind("test", [&](const IndexableName&, const SharedNodeData& data) {
+        const auto size = CastNodeData<std::vector<int>>(data)->Get().size();
+        EXPECT_LE(size, 512u);
+        largest = std::max<std::size_t>(largest, size);
+        if ((received += static_cast<int>(size)) == producers * count) done.count_down();
+    });
+
+    {
+        std::vector<std::jthread> threads;
+        for (int p = 0; p < producers; ++p)
+        {
+            threads.emplace_back([&] {
+                for (int i = 0; i < count; ++i)
+                {
+                    node->Push(i);
+                }
+            });
+        }
+    }
+
+    done.wait();
+    EXPECT_EQ(node->Size(), 0u);
+    EXPECT_GT(largest, 1u);
+
+    // A single event is drained once the latency bound passes.
+    node->SetLatencyBound(std::chrono::milliseconds(1));
+    std::latch single(1);
+    node->OnSetOutput.Unbind("test");
+    node->OnSetOutput.Bind("test", [&](const IndexableName&, const SharedNodeData& data) {
+        EXPECT_EQ(CastNodeData<std::vector<int>>(data)->Get(), std::vector{42});
+        single.count_down();
+    });
+    node->Push(42);
+    single.wait();
+
+    test::env->Wait();
+}
+
+namespace NodeTest
+{
+struct Opaque
+{
+    int value = 0;
+};
+
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(Opaque, value)
+} // namespace NodeTest
+
+TEST(NodeTest, ChangeDetection)
+{
+    auto graph = std::make_shared<Graph>("test", test::env);
+    auto node = std::make_shared<FunctionNode<decltype(return_test_method), return_test_method>>(UUID{}, "return",
+                                                                                                  test::env);
+    graph->AddNode(node);
+
+    int emitted = 0;
+    node->OnEmitOutput.Bind("test", [&](const UUID&, const IndexableName&, const SharedNodeData&) { ++emitted; });
+
+    node->SetInputData("a", MakeNodeData(1));
+    node->SetInputData("a", MakeNodeData(1));
+    EXPECT_EQ(emitted, 2);
+
+    EXPECT_FALSE(node->GetChangeDetection("return"));
+    node->SetChangeDetection("return", true);
+    EXPECT_TRUE(node->GetChangeDetection("return"));
+
+    node->SetInputData("a", MakeNodeData(1));
+    EXPECT_EQ(emitted, 2);
+    node->SetInputData("a", MakeNodeData(2));
+    EXPECT_EQ(emitted, 3);
+    EXPECT_EQ(node->GetOutputData<int>("return")->Get(), 2);
+
+    node->SetChangeDetection("return", false);
+    node->SetInputData("a", MakeNodeData(2));
+    EXPECT_EQ(emitted, 4);
+}
+
+TEST(NodeTest, RegisteredEquality)
+{
+    // A factory of its own, so that the registered equality does not leak into other tests, or repeats of this one.
+    auto factory = std::make_shared<NodeFactory>();
+    NodeTest::TestNode node(Env::Create(factory));
+    node.AddOutput<NodeTest::Opaque>("out", "");
+
+    EXPECT_THROW(node.SetChangeDetection("out", true), std::invalid_argument);
+
+    factory->RegisterEquality<NodeTest::Opaque>([](const SharedNodeData& lhs, const SharedNodeData& rhs) {
+        return CastNodeData<NodeTest::Opaque>(lhs)->Get().value == CastNodeData<NodeTest::Opaque>(rhs)->Get().value;
+    });
+    ASSERT_NO_THROW(node.SetChangeDetection("out", true));
+
+    node.SetOutputData("out", MakeNodeData(NodeTest::Opaque{1}), false);
+    EXPECT_TRUE(node.GetOutputPort("out")->IsUnchanged(MakeNodeData(NodeTest::Opaque{1})));
+    EXPECT_FALSE(node.GetOutputPort("out")->IsUnchanged(MakeNodeData(NodeTest::Opaque{2})));
+
+    // The same data may have been modified in place, so it always counts as changed.
+    EXPECT_FALSE(node.GetOutputPort("out")->IsUnchanged(node.GetOutputData("out")));
+}
+
+namespace NodeTest
+{
+int count_opaque(std::vector<Opaque> values) { return static_cast<int>(values.size()); }
+} // namespace NodeTest
+
+TEST(NodeTest, NestedEquality)
+{
+    static_assert(concepts::EqualityComparable<std::vector<std::pair<int, std::string>>>);
+    static_assert(!concepts::EqualityComparable<std::vector<NodeTest::Opaque>>);
+    static_assert(!concepts::EqualityComparable<std::map<int, std::optional<NodeTest::Opaque>>>);
+
+    // Ports of containers of types without operator== get no equality, instead of failing to compile.
+    NodeTest::TestNode node;
+    node.AddOutput<std::vector<NodeTest::Opaque>>("out", "");
+    EXPECT_THROW(node.SetChangeDetection("out", true), std::invalid_argument);
+
+    using CountNode = FunctionNode<decltype(NodeTest::count_opaque), NodeTest::count_opaque>;
+
+    auto graph = std::make_shared<Graph>("test", test::env);
+    auto count = std::make_shared<CountNode>(UUID{}, "count", test::env);
+    graph->AddNode(count);
+
+    count->SetInputData("a", MakeNodeData(std::vector<NodeTest::Opaque>(3)));
+    EXPECT_EQ(count->GetOutputData<int>("return")->Get(), 3);
+}
+
+namespace NodeTest
+{
+int pure_calls = 0;
+
+/**
+ * @brief Starts the result cache of a function node class over for the lifetime of the scope.
+ *
+ * @details The cache is shared by all nodes of the class, so its entries and statistics would otherwise carry over to
+ *          other tests, and repeats of the same test.
+ */
+template<typename T>
+struct CacheScope
+{
+    explicit CacheScope(std::size_t budget)
+    {
+        T::ClearCache();
+        T::SetCacheBudget(budget);
+    }
+
+    ~CacheScope()
+    {
+        T::SetCacheBudget(0);
+        T::ClearCache();
+    }
+
+    CacheScope(const CacheScope&)            = delete;
+    CacheScope& operator=(const CacheScope&) = delete;
+};
+
+std::size_t pure_length(std::string str, int scale)
+{
+    ++pure_calls;
+    return str.size() * scale;
+}
+
+int sum(std::vector<int> values)
+{
+    ++pure_calls;
+    return std::accumulate(values.begin(), values.end(), 0);
+}
+} // namespace NodeTest
+
+TEST(NodeTest, ResultCache)
+{
+    using PureNode = FunctionNode<decltype(NodeTest::pure_length), NodeTest::pure_length>;
+
+    auto graph = std::make_shared<Graph>("test", test::env);
+    auto node  = std::make_shared<PureNode>(UUID{}, "pure", test::env);
+    graph->AddNode(node);
+
+    NodeTest::CacheScope<PureNode> cache(1024 * 1024);
+    NodeTest::pure_calls = 0;
+
+    node->SetInputData("b", MakeNodeData(2), false);
+    for (const auto* str : {"abc", "abcd", "abc", "abc", "abcd"})
+    {
+        node->SetInputData("a", MakeNodeData<std::string>(str));
+        EXPECT_EQ(node->GetOutputData<std::size_t>("return")->Get(), std::string{str}.size() * 2);
+    }
+
+    auto stats = PureNode::GetCacheStats();
+    EXPECT_EQ(NodeTest::pure_calls, 2);
+    EXPECT_EQ(stats.Hits, 3u);
+    EXPECT_EQ(stats.Misses, 2u);
+    EXPECT_EQ(stats.Entries, 2u);
+    EXPECT_GT(stats.Bytes, 0u);
+
+    // A budget that only fits one result evicts the least recently used one.
+    PureNode::SetCacheBudget(stats.Bytes / 2 + 1);
+    stats = PureNode::GetCacheStats();
+    EXPECT_EQ(stats.Entries, 1u);
+    EXPECT_EQ(stats.Evictions, 1u);
+
+    node->SetInputData("a", MakeNodeData<std::string>("abcd"));
+    node->SetInputData("a", MakeNodeData<std::string>("abc"));
+    EXPECT_EQ(NodeTest::pure_calls, 3);
+
+    PureNode::SetCacheBudget(0);
+    EXPECT_EQ(PureNode::GetCacheStats().Entries, 0u);
+    node->SetInputData("a", MakeNodeData<std::string>("abc"));
+    EXPECT_EQ(NodeTest::pure_calls, 4);
+}
+
+TEST(NodeTest, RegisteredHash)
+{
+    using SumNode = FunctionNode<decltype(NodeTest::sum), NodeTest::sum>;
+
+    // A factory of its own, so that the registered hash does not leak into other tests, or repeats of this one.
+    auto factory = std::make_shared<NodeFactory>();
+    auto env     = Env::Create(factory);
+    auto graph   = std::make_shared<Graph>("test", env);
+    auto node    = std::make_shared<SumNode>(UUID{}, "sum", env);
+    graph->AddNode(node);
+
+    NodeTest::CacheScope<SumNode> cache(1024);
+    NodeTest::pure_calls = 0;
+
+    // Without a hash the inputs cannot be cached.
+    node->SetInputData("a", MakeNodeData(std::vector{1, 2, 3}));
+    node->SetInputData("a", MakeNodeData(std::vector{1, 2, 3}));
+    EXPECT_EQ(NodeTest::pure_calls, 2);
+
+    factory->RegisterHash<std::vector<int>>([](const std::vector<int>& values) { return values.size(); });
+    node->SetInputData("a", MakeNodeData(std::vector{1, 2, 3}));
+    node->SetInputData("a", MakeNodeData(std::vector{1, 2, 3}));
+    node->SetInputData("a", MakeNodeData(std::vector{1, 2, 4}));
+    EXPECT_EQ(NodeTest::pure_calls, 4);
+    EXPECT_EQ(node->GetOutputData<int>("return")->Get(), 7);
+
+    const auto stats = SumNode::GetCacheStats();
+    EXPECT_EQ(stats.Hits, 1u);
+    EXPECT_EQ(stats.Entries, 2u);
+}
+
+namespace NodeTest
+{
+int scale(int value, int factor) { return value * factor; }
+} // namespace NodeTest
+
+TEST(NodeTest, ColumnBatch)
+{
+    Column<int> column;
+    column.PushBack(1);
+    column.PushNull();
+    column.PushBack(3);
+    ASSERT_EQ(column.Size(), 3);
+    EXPECT_EQ(column.NullCount(), 1);
+    EXPECT_FALSE(column.IsValid(1));
+    EXPECT_EQ(MakeNodeData(std::as_const(column))->ToString(), "[ 1, null, 3 ]");
+
+    using ScaleNode = FunctionNode<decltype(NodeTest::scale), NodeTest::scale>;
+    auto node       = std::make_shared<ScaleNode>(UUID{}, "scale", test::env);
+    EXPECT_TRUE(node->SupportsBatch());
+
+    // The scalar input is broadcast to every record of the column.
+    node->SetInputData("b", MakeNodeData(3), false);
+    node->SetInputData("a", MakeNodeData(std::as_const(column)));
+    EXPECT_TRUE(node->HasBatchInput());
+
+    auto result = node->GetOutputData<Column<int>>("return");
+    ASSERT_NE(result, nullptr);
+    ASSERT_EQ(result->Get().Size(), 3);
+    EXPECT_EQ(result->Get()[0], 3);
+    EXPECT_FALSE(result->Get().IsValid(1));
+    EXPECT_EQ(result->Get()[2], 9);
+
+    // Single values replace the batch on the same ports.
+    node->SetInputData("a", MakeNodeData(2));
+    EXPECT_FALSE(node->HasBatchInput());
+    ASSERT_NE(node->GetOutputData<int>("return"), nullptr);
+    EXPECT_EQ(node->GetOutputData<int>("return")->Get(), 6);
+}
+
+TEST(NodeTest, CompactLayout)
+{
+    NodeTest::TestNode first;
+    NodeTest::TestNode second;
+    first.AddInput<int>("in", "Input");
+    first.AddInput<int>("other", "Other");
+    second.AddInput<int>("in", "Input");
+
+    // Class names and port captions are interned, and shared between the nodes.
+    EXPECT_EQ(&first.GetClass(), &second.GetClass());
+    EXPECT_EQ(first.GetInputPort("in")->GetCaption().data(), second.GetInputPort("in")->GetCaption().data());
+
+    // Captions set at runtime are owned by the port instead.
+    first.GetInputPort("in")->SetCaption("Renamed");
+    EXPECT_EQ(first.GetInputPort("in")->GetCaption(), "Renamed");
+    EXPECT_EQ(second.GetInputPort("in")->GetCaption(), "Input");
+
+    // Ports are kept in declaration order.
+    std::vector<std::string_view> keys;
+    for (const auto& [key, _] : first.GetInputPorts())
+    {
+        keys.push_back(key);
+    }
+    EXPECT_EQ(keys, (std::vector<std::string_view>{"in", "other"}));
+
+    EXPECT_THROW(std::ignore = first.GetInputPort("missing"), std::out_of_range);
+    EXPECT_EQ(InternedString{"in"}, InternedString{std::string{"in"}});
+}
+
+TEST(NodeTest, ConcurrentEventBinding)
+{
+    EventDispatcher<int> dispatcher;
+    EXPECT_FALSE(dispatcher.HasSubscribers());
+
+    std::atomic<int> sum   = 0;
+    std::atomic<bool> done = false;
+
+    std::thread broadcaster([&] {
+        while (!done)
+        {
+            dispatcher.Broadcast(1);
+        }
+    });
+
+    std::vector<std::thread> binders;
+    for (int i = 0; i < 4; ++i)
+    {
+        binders.emplace_back([&, i] {
+            for (int j = 0; j < 100; ++j)
+            {
+                const auto key  = std::to_string(i * 100 + j);
+                const auto name = IndexableName{key};
+                dispatcher.Bind(name, [&](int value) { sum += value; });
+                dispatcher.Unbind(name);
+            }
+        });
+    }
+
+    for (auto& binder : binders)
+    {
+        binder.join();
+    }
+
+    done = true;
+    broadcaster.join();
+    EXPECT_FALSE(dispatcher.HasSubscribers());
+
+    dispatcher.Bind("first", [&](int value) { sum = value; });
+    dispatcher.Bind("first", [&](int) { sum = -1; });
+    ASSERT_TRUE(dispatcher.HasSubscribers());
+
+    dispatcher.Broadcast(5);
+    EXPECT_EQ(sum, 5);
+
+    dispatcher.UnbindAll();
+    EXPECT_FALSE(dispatcher.HasSubscribers());
+}
+
+TEST(NodeTest, RetentionPolicy)
+{
+    using Image = std::vector<std::uint8_t>;
+
+    auto image = MakeNodeData(Image(1 << 16, 7));
+    EXPECT_GE(image->SizeInBytes(), 1 << 16);
+
+    auto graph = std::make_shared<Graph>("test", test::env);
+    auto node  = std::make_shared<NodeTest::TestNode>();
+    node->AddInput<int>("in", "");
+    node->AddInput<Image>("image", "");
+    node->AddOutput<int>("out", "");
+    graph->AddNode(node);
+
+    node->SetInputData("image", image, false);
+    EXPECT_GE(graph->MemoryUsage(), image->SizeInBytes());
+
+    // Spilled once consumed by a compute, and read back when accessed.
+    const auto& image_port = node->GetInputPort("image");
+    image_port->SetRetention(RetentionPolicy::Spill);
+    node->SetInputData("in", MakeNodeData<int>(1));
+    EXPECT_TRUE(image_port->IsSpilled());
+    EXPECT_LT(graph->MemoryUsage(), 1 << 16);
+    EXPECT_EQ(node->GetOutputData<int>("out")->Get(), 1);
+
+    auto restored = CastNodeData<Image>(image_port->GetData());
+    EXPECT_FALSE(image_port->IsSpilled());
+    EXPECT_EQ(restored->Get(), Image(1 << 16, 7));
+
+    node->GetInputPort("in")->SetRetention(RetentionPolicy::ReleaseAfterConsume);
+    node->GetOutputPort("out")->SetRetention(RetentionPolicy::ReleaseAfterConsume);
+    node->SetInputData("in", MakeNodeData<int>(2));
+    EXPECT_EQ(node->GetInputData("in"), nullptr);
+    EXPECT_EQ(node->GetOutputData("out"), nullptr);
+}
@@ -0,0 +1,156 @@
+#include <cxxopts.hpp>
+#include <flow/core/Env.hpp>
+#include <flow/core/Graph.hpp>
+#include <flow/core/Node.hpp>
+#include <flow/core/NodeFactory.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace
+{
+std::atomic<std::int64_t> allocated_bytes = 0;
+
+// Allocations are prefixed with their size, so that the bytes in use can be tracked without sized deallocation.
+constexpr std::size_t header_size = alignof(std::max_align_t);
+
+void* Allocate(std::size_t size)
+{
+    auto* block = static_cast<std::byte*>(std::malloc(size + header_size));
+    if (!block)
+    {
+        throw std::bad_alloc();
+    }
+
+    *reinterpret_cast<std::size_t*>(block) = size;
+    allocated_bytes.fetch_add(static_cast<std::int64_t>(size), std::memory_order_relaxed);
+    return block + header_size;
+}
+
+void Deallocate(void* ptr) noexcept
+{
+    if (!ptr)
+    {
+        return;
+    }
+
+    auto* block = static_cast<std::byte*>(ptr) - header_size;
+    allocated_bytes.fetch_sub(static_cast<std::int64_t>(*reinterpret_cast<std::size_t*>(block)),
+                              std::memory_order_relaxed);
+    std::free(block);
+}
+
+struct FootprintNode : public flow::Node
+{
+    FootprintNode(std::shared_ptr<flow::Env> env)
+        : flow::Node(flow::UUID{}, flow::TypeName_v<FootprintNode>, "footprint", std::move(env))
+    {
+        AddInput<int>("a", "First operand");
+        AddInput<int>("b", "Second operand");
+        AddOutput<int>("result", "Sum of the operands");
+    }
+
+    void Compute() override
+    {
+        auto a = GetInputData<int>("a");
+        auto b = GetInputData<int>("b");
+        if (a && b)
+        {
+            SetOutputData("result", flow::MakeNodeData(a->Get() + b->Get()));
+        }
+    }
+};
+} // namespace
+
+void* operator new(std::size_t size) { return Allocate(size); }
+void* operator new[](std::size_t size) { return Allocate(size); }
+void operator delete(void* ptr) noexcept { Deallocate(ptr); }
+void operator delete[](void* ptr) noexcept { Deallocate(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { Deallocate(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { Deallocate(ptr); }
+
+int main(int argc, char** argv)
+{
+    // clang-format off
+    cxxopts::Options options("FlowFootprint", "Measures the memory used by the nodes and connections of a graph");
+    options.add_options()
+        ("n,nodes", "Number of nodes to create", cxxopts::value<std::size_t>()->default_value("100000"))
+        ("h,help", "Print usage");
+    // clang-format on
+
+    cxxopts::ParseResult result;
+
+    try
+    {
+        result = options.parse(argc, argv);
+    }
+    catch (const cxxopts::exceptions::exception& e)
+    {
+        std::cerr << "Caught exception while parsing arguments: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (result.count("help"))
+    {
+        std::cerr << options.help() << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    const auto count = result["nodes"].as<std::size_t>();
+    if (count == 0)
+    {
+        std::cerr << "Number of nodes must be positive" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    auto env   = flow::Env::Create(std::make_shared<flow::NodeFactory>());
+    auto graph = std::make_shared<flow::Graph>("footprint", env);
+
+    std::vector<std::shared_ptr<FootprintNode>> nodes;
+    nodes.reserve(count);
+
+    const auto baseline = allocated_bytes.load();
+    const auto start    = std::chrono::steady_clock::now();
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        nodes.push_back(std::make_shared<FootprintNode>(env));
+    }
+
+    const auto node_bytes = allocated_bytes.load() - baseline;
+
+    for (const auto& node : nodes)
+    {
+        graph->AddNode(node);
+    }
+
+    const auto graph_bytes = allocated_bytes.load() - baseline - node_bytes;
+
+    for (std::size_t i = 1; i < count; ++i)
+    {
+        graph->ConnectNodes(nodes[i - 1]->ID(), "result", nodes[i]->ID(), "a");
+    }
+
+    const auto connection_bytes = allocated_bytes.load() - baseline - node_bytes - graph_bytes;
+    const auto elapsed =
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+    const auto per = [](std::int64_t bytes, std::size_t n) { return n == 0 ? 0.0 : double(bytes) / double(n); };
+
+    std::cout << "sizeof(Node):        " << sizeof(flow::Node) << " bytes\n";
+    std::cout << "sizeof(Port):        " << sizeof(flow::Port) << " bytes\n";
+    std::cout << "nodes:               " << count << "\n";
+    std::cout << "node memory:         " << node_bytes << " bytes (" << per(node_bytes, count) << " per node)\n";
+    std::cout << "graph memory:        " << graph_bytes << " bytes (" << per(graph_bytes, count) << " per node)\n";
+    std::cout << "connection memory:   " << connection_bytes << " bytes (" << per(connection_bytes, count - 1)
+              << " per connection)\n";
+    std::cout << "total:               " << (node_bytes + graph_bytes + connection_bytes) << " bytes in "
+              << elapsed.count() << " ms" << std::endl;
+
+    return EXIT_SUCCESS;
+}